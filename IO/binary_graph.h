@@ -0,0 +1,181 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary CSR graph file, all values little endian:
+//   csr_header
+//   uint64_t offsets[n + 1]   (offsets[n] == m, number of adjacency entries)
+//   uint32_t adj[m]           (sorted, 0-indexed neighbours)
+// The checksum covers the offset and neighbour arrays.
+
+#define CSR_MAGIC "MISCSR\r\n"
+#define CSR_VERSION 1
+#define CSR_SUFFIX ".csr"
+#define CSR_TMP_SUFFIX ".tmp" // appended while a file is written
+
+struct csr_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t n;
+    uint64_t m;
+    uint64_t checksum;
+};
+
+// FNV-1a over 64-bit words, tail bytes are zero padded
+inline uint64_t csrChecksum(const void *data, size_t size, uint64_t h = 0xcbf29ce484222325ULL)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0x100000001b3ULL;
+    }
+    if (i < size)
+    {
+        uint64_t w = 0;
+        memcpy(&w, p + i, size - i);
+        h = (h ^ w) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// View of a mapped CSR file, neighbours of v are adj[offsets[v]] .. adj[offsets[v + 1] - 1].
+// The mapping is private copy-on-write, so the solver can use and edit adj in place.
+struct csr_graph
+{
+    int n = 0;
+    long long m = 0;
+    const uint64_t *offsets = nullptr;
+    uint32_t *adj = nullptr;
+
+    void *data = nullptr;
+    size_t size = 0;
+
+    csr_graph() {}
+    csr_graph(const csr_graph &) = delete;
+    csr_graph &operator=(const csr_graph &) = delete;
+    ~csr_graph()
+    {
+        if (data != nullptr)
+            munmap(data, size);
+    }
+
+    int deg(int v) const { return offsets[v + 1] - offsets[v]; }
+    const uint32_t *begin(int v) const { return adj + offsets[v]; }
+    const uint32_t *end(int v) const { return adj + offsets[v + 1]; }
+};
+
+bool writeBinaryGraph(const std::vector<std::vector<int>> &graph, std::string fileName)
+{
+    csr_header h;
+    memcpy(h.magic, CSR_MAGIC, 8);
+    h.version = CSR_VERSION;
+    h.reserved = 0;
+    h.n = graph.size();
+
+    std::vector<uint64_t> offsets(graph.size() + 1, 0);
+    for (size_t v = 0; v < graph.size(); v++)
+        offsets[v + 1] = offsets[v] + graph[v].size();
+    h.m = offsets.back();
+
+    std::vector<uint32_t> adj;
+    adj.reserve(h.m);
+    for (auto &nb : graph)
+        adj.insert(adj.end(), nb.begin(), nb.end());
+
+    h.checksum = csrChecksum(offsets.data(), offsets.size() * sizeof(uint64_t));
+    h.checksum = csrChecksum(adj.data(), adj.size() * sizeof(uint32_t), h.checksum);
+
+    // write to a temporary name so a partial file is never picked up
+    std::string tmpName = fileName + CSR_TMP_SUFFIX;
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (f == nullptr)
+        return false;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = ok && fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), f) == offsets.size();
+    ok = ok && fwrite(adj.data(), sizeof(uint32_t), adj.size(), f) == adj.size();
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmpName.c_str(), fileName.c_str()) != 0)
+    {
+        remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Maps a binary CSR file, returns false (leaving g empty) if the file is missing or invalid
+bool readBinaryGraph(std::string fileName, csr_graph &g)
+{
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(csr_header))
+    {
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    const csr_header *h = (const csr_header *)data;
+    // n and m are bounded by the file size before the expected size is computed, so it cannot overflow;
+    // negative values written as uint64_t are too large
+    size_t body = st.st_size - sizeof(csr_header);
+    bool valid = memcmp(h->magic, CSR_MAGIC, 8) == 0 && h->version == CSR_VERSION && h->n <= INT32_MAX &&
+                 h->n < body / sizeof(uint64_t) && h->m <= body / sizeof(uint32_t);
+    if (!valid || sizeof(csr_header) + (h->n + 1) * sizeof(uint64_t) + h->m * sizeof(uint32_t) != (size_t)st.st_size)
+    {
+        std::cout << "Invalid binary graph: " << fileName << std::endl;
+        munmap(data, st.st_size);
+        return false;
+    }
+
+    const uint64_t *offsets = (const uint64_t *)((const char *)data + sizeof(csr_header));
+    uint32_t *adj = (uint32_t *)(offsets + h->n + 1);
+    uint64_t checksum = csrChecksum(offsets, (h->n + 1) * sizeof(uint64_t));
+    checksum = csrChecksum(adj, h->m * sizeof(uint32_t), checksum);
+    if (checksum != h->checksum || offsets[h->n] != h->m)
+    {
+        std::cout << "Checksum mismatch in binary graph: " << fileName << std::endl;
+        munmap(data, st.st_size);
+        return false;
+    }
+
+    g.n = h->n;
+    g.m = h->m;
+    g.offsets = offsets;
+    g.adj = adj;
+    g.data = data;
+    g.size = st.st_size;
+    return true;
+}
+
+// Binary sidecar of a text graph, used only if it is newer than the text file
+bool hasFreshBinaryGraph(std::string fileName)
+{
+    struct stat txt, bin;
+    if (stat((fileName + CSR_SUFFIX).c_str(), &bin) != 0)
+        return false;
+    if (stat(fileName.c_str(), &txt) != 0)
+        return true;
+    return bin.st_mtim.tv_sec > txt.st_mtim.tv_sec ||
+           (bin.st_mtim.tv_sec == txt.st_mtim.tv_sec && bin.st_mtim.tv_nsec > txt.st_mtim.tv_nsec);
+}
@@ -5,6 +5,15 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <thread>
+#include <atomic>
+#include <utility>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 std::vector<std::vector<int>> readGraph(std::istream &infile)
@@ -78,13 +87,210 @@ std::vector<std::vector<int>> readGraph(std::istream &infile)
     return graph;
 }
 
+// Minimum number of bytes per parser thread, smaller inputs use fewer threads
+#define PARSE_CHUNK_MIN (1 << 20)
+
+// Reads an int the way operator>> does on a single line: leading whitespace is
+// skipped, and if no digits follow the result is 0 (as for a failed extraction).
+inline const char *parseInt(const char *p, const char *end, int &val)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\v' || *p == '\f'))
+        p++;
+
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        neg = *p == '-';
+        p++;
+    }
+
+    if (p == end || *p < '0' || *p > '9')
+    {
+        val = 0;
+        return end;
+    }
+
+    long long r = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        r = r * 10 + (*p++ - '0');
+
+    val = (int)(neg ? -r : r);
+    return p;
+}
+
+struct parse_chunk
+{
+    std::vector<std::pair<int, int>> edges;
+    const char *error = nullptr; // first line with an invalid node id
+    int errorId = 0;
+};
+
+// Parses all lines starting in [begin, end), edges are stored 0-indexed without self-loops
+inline void parseEdgeChunk(const char *begin, const char *end, int numVertices, parse_chunk &res)
+{
+    const char *p = begin;
+    while (p < end)
+    {
+        const char *le = (const char *)memchr(p, '\n', end - p);
+        if (le == nullptr)
+            le = end;
+
+        if (le != p && *p != 'c')
+        {
+            int u, v;
+            parseInt(parseInt(p, le, u), le, v);
+            u--;
+            v--;
+
+            if (u < 0 || u >= numVertices || v < 0 || v >= numVertices)
+            {
+                res.error = p;
+                res.errorId = (u < 0 || u >= numVertices) ? u : v;
+                return;
+            }
+
+            if (u != v)
+                res.edges.emplace_back(u, v);
+        }
+        p = le + 1;
+    }
+}
+
+std::vector<std::vector<int>> readGraphMapped(const char *data, size_t size)
+{
+    const char *end = data + size;
+    const char *p = data;
+
+    // header, same rules as readGraph
+    int numVertices = 0;
+    int numEdges = 0;
+    while (p < end)
+    {
+        const char *le = (const char *)memchr(p, '\n', end - p);
+        if (le == nullptr)
+            le = end;
+        std::istringstream iss(std::string(p, le));
+        p = le < end ? le + 1 : end;
+
+        char firstSymbol;
+        if (!(iss >> firstSymbol))
+        {
+            break;
+        } // error
+
+        if (firstSymbol == 'p')
+        {
+            std::string td;
+            iss >> td >> numVertices >> numEdges;
+            break;
+        }
+    }
+
+    // split remaining input at line boundaries
+    int nThreads = std::max(1, (int)std::min<size_t>(std::thread::hardware_concurrency(), (end - p) / PARSE_CHUNK_MIN));
+    std::vector<const char *> bounds(nThreads + 1, end);
+    bounds[0] = p;
+    for (int i = 1; i < nThreads; i++)
+    {
+        const char *b = p + (end - p) / nThreads * i;
+        b = std::max(b, bounds[i - 1]);
+        const char *nl = (const char *)memchr(b, '\n', end - b);
+        bounds[i] = nl == nullptr ? end : nl + 1;
+    }
+
+    std::vector<parse_chunk> chunks(nThreads);
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nThreads; i++)
+            threads.emplace_back(parseEdgeChunk, bounds[i], bounds[i + 1], numVertices, std::ref(chunks[i]));
+        for (auto &th : threads)
+            th.join();
+    }
+
+    for (auto &c : chunks)
+    {
+        if (c.error != nullptr)
+        {
+            std::cout << "Invalid node ID: " << c.errorId << std::endl;
+            exit(1);
+        }
+    }
+
+    // count degrees, then scatter both directions into one CSR array
+    std::vector<std::atomic<long long>> offset(numVertices + 1);
+    auto parallelFor = [nThreads](long long count, auto f) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nThreads; t++)
+            threads.emplace_back([=]() {
+                for (long long i = count * t / nThreads; i < count * (t + 1) / nThreads; i++)
+                    f(i, t);
+            });
+        for (auto &th : threads)
+            th.join();
+    };
+
+    parallelFor(nThreads, [&](long long c, int) {
+        for (auto &e : chunks[c].edges)
+        {
+            offset[e.first + 1].fetch_add(1, std::memory_order_relaxed);
+            offset[e.second + 1].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (int i = 0; i < numVertices; i++)
+        offset[i + 1].store(offset[i + 1].load(std::memory_order_relaxed) + offset[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    std::vector<int> edges(offset[numVertices].load());
+    std::vector<long long> begin(numVertices + 1);
+    for (int i = 0; i <= numVertices; i++)
+        begin[i] = offset[i].load(std::memory_order_relaxed);
+
+    parallelFor(nThreads, [&](long long c, int) {
+        for (auto &e : chunks[c].edges)
+        {
+            edges[offset[e.first].fetch_add(1, std::memory_order_relaxed)] = e.second;
+            edges[offset[e.second].fetch_add(1, std::memory_order_relaxed)] = e.first;
+        }
+        std::vector<std::pair<int, int>>().swap(chunks[c].edges);
+    });
+
+    // sort and dedup every list
+    std::vector<std::vector<int>> graph(numVertices);
+    parallelFor(numVertices, [&](long long i, int) {
+        auto b = edges.begin() + begin[i], e = edges.begin() + begin[i + 1];
+        std::sort(b, e);
+        graph[i].assign(b, std::unique(b, e));
+    });
+
+    return graph;
+}
+
 std::vector<std::vector<int>> readGraphFromFile(std::string fileName)
 {
-    std::ifstream fin(fileName);
-    return readGraph(fin);
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        if (fd >= 0)
+            close(fd);
+        std::ifstream fin(fileName);
+        return readGraph(fin);
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        std::ifstream fin(fileName);
+        return readGraph(fin);
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    std::vector<std::vector<int>> graph = readGraphMapped((const char *)data, st.st_size);
+    munmap(data, st.st_size);
+    return graph;
 }
 
 std::vector<std::vector<int>> readGraphFromCin()
 {
     return readGraph(std::cin);
-}
\ No newline at end of file
+}
@@ -9,6 +9,7 @@ public:
 
     std::string instance;
     long nBranchings;
+    long nSmallBranchings = -1; // nodes of the bitset search of small kernels
     double time;
     long misSize;
 
@@ -33,6 +34,7 @@ void writeResult(Result& sol, std::ostream &f) {
       << " nDefPicks: " << sol.nDefaultPicks
       << " nStratPicks: " << sol.nStratPicks
       << " nDefBranchings: " << sol.nDefaultBranchings
+      << " nSmallBranchings: " << sol.nSmallBranchings
       << std::endl;
 }
 
@@ -19,6 +19,7 @@
 #include "branch_and_reduce_algorithm.h"
 #include "fast_set.h"
 #include "modified.h"
+#include "tools/remote_pool.h"
 
 #include <stack>
 #include <vector>
@@ -40,33 +41,13 @@
 
 using namespace std;
 
-int branch_and_reduce_algorithm::REDUCTION = 3;
-int branch_and_reduce_algorithm::LOWER_BOUND = 4;
-int branch_and_reduce_algorithm::BRANCHING = 2;
-bool branch_and_reduce_algorithm::outputLP = false;
-long branch_and_reduce_algorithm::nBranchings = 0;
-int branch_and_reduce_algorithm::debug = 0;
-
-int branch_and_reduce_algorithm::EXTRA_DECOMP = 0;
-
-long branch_and_reduce_algorithm::TUNING_PARAM1 = 7;
-double branch_and_reduce_algorithm::TUNING_PARAM2 = 0.1;
-long branch_and_reduce_algorithm::TUNING_PARAM3 = 10;
-
-long branch_and_reduce_algorithm::defaultBranchings = 0;
-bool branch_and_reduce_algorithm::defaultBranch = false;
-long branch_and_reduce_algorithm::defaultPicks = 0;
-long branch_and_reduce_algorithm::stratPicks = 0;
-long branch_and_reduce_algorithm::nDecomps = 0;
-long branch_and_reduce_algorithm::prunes = 0;
-
-bool branch_and_reduce_algorithm::USE_DEPENDENCY_CHECKING = false;
-
-branch_and_reduce_algorithm::branch_and_reduce_algorithm(std::vector<std::vector<int>> &_adj, int const _N)
-    : adj(), n(_adj.size()), used(n * 2), ls_refinement(partition_index, x, adj), dc_candidates(_N), 
+branch_and_reduce_algorithm::branch_and_reduce_algorithm(dyn_csr &_adj, int const _N, solver_config const &_config)
+    : config(_config), stats(std::make_shared<solver_stats>()), adj(), n(_adj.size()), used(n * 2), ls_refinement(partition_index, x, adj), dc_candidates(_N), 
     packingMap(_N), foldingMap(_N), candidatesChecked(_N)
 {
     SHRINK = 0.5;
+    COMPACT = 0.5;
+    SHRINK_COMPACT = 0.75;
     depth = 0;
     maxDepth = 10;
     rootDepth = -1; // invalid value
@@ -88,6 +69,15 @@ branch_and_reduce_algorithm::branch_and_reduce_algorithm(std::vector<std::vector
     for (int i = n; i < N; i++)
         x[i] = 2;
     rn = n;
+    liveDeg.resize(n);
+    degBuckets = degree_buckets(n);
+    liveSet.Resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        liveDeg[i] = adj[i].size();
+        degBuckets.insert(i, liveDeg[i]);
+        liveSet.Insert(i);
+    }
     in.resize(n, -1);
     out.resize(n, -1);
     lb = -1; // invalid value
@@ -99,29 +89,51 @@ branch_and_reduce_algorithm::branch_and_reduce_algorithm(std::vector<std::vector
     iter.resize(n * 2, 0);
 
     modTmp.resize(n, 0);
+    compactN = n;
+    denseN = n;
+    vertexOne = 1;
 
     modifiedN = 0;
-    modifieds.resize(N, shared_ptr<modified>());
+    modifieds.resize(N);
 
     // MODIFICATIONS
     s = t = -1;
     partition_index.resize(n,1);
 
-    if (USE_DEPENDENCY_CHECKING) {
+    if (config.USE_DEPENDENCY_CHECKING) {
         for (int i = 0; i < adj.size(); i++)
             dc_candidates.Insert(i);
     }
 }
 
+branch_and_reduce_algorithm::~branch_and_reduce_algorithm()
+{
+    gcn_cache_free(model, gcnCache);
+    gcn_cache_free(gcnRef, gcnRefCache);
+}
+
 int branch_and_reduce_algorithm::deg(int v)
 {
     assert(x[v] < 0);
-    int deg = 0;
-    for (int u : adj[v])
-        if (x[u] < 0)
-            deg++;
+    return liveDeg[v];
+}
 
-    return deg;
+std::vector<int> branch_and_reduce_algorithm::remaining_vertices() const
+{
+    std::vector<int> vs;
+    vs.reserve(rn);
+    if (rn * 16 >= denseN)
+    {
+        for (int v = 0; v < denseN; v++)
+            if (x[v] < 0)
+                vs.push_back(v);
+    }
+    else
+    {
+        vs.assign(liveSet.begin(), liveSet.end());
+        std::sort(vs.begin(), vs.end());
+    }
+    return vs;
 }
 
 void branch_and_reduce_algorithm::getPackingCandidates(int v) {
@@ -141,10 +153,10 @@ void branch_and_reduce_algorithm::set(int v, int a)
 {
     assert(x[v] < 0);
     crt += a;
-    x[v] = a;
+    remove_vertex(v, a);
     vRestore[--rn] = v;
 
-    if (BRANCHING >= 20){
+    if (config.BRANCHING >= 20){
         if (partition_index[v] == 2)
             perform_refinement = true;
 
@@ -154,7 +166,7 @@ void branch_and_reduce_algorithm::set(int v, int a)
         }
     }
 
-    if (USE_DEPENDENCY_CHECKING) {
+    if (config.USE_DEPENDENCY_CHECKING) {
         for (int n : adj[v]) {
             dc_candidates.Insert(n);
         }
@@ -165,7 +177,7 @@ void branch_and_reduce_algorithm::set(int v, int a)
 
     if (a == 0)
     {
-        if (BRANCHING >= 20){
+        if (config.BRANCHING >= 20){
             for (int u : adj[v]) {
                 for (int n : adj[u]) {
                     if (x[n] < 0 && partition_index[n] == 2)
@@ -174,7 +186,7 @@ void branch_and_reduce_algorithm::set(int v, int a)
             }
         }
 
-        if(USE_DEPENDENCY_CHECKING) {
+        if(config.USE_DEPENDENCY_CHECKING) {
             for (int n : adj[v]) {
                 if (x[n] < 0) {
                     for (int nn : adj[n]){
@@ -189,7 +201,7 @@ void branch_and_reduce_algorithm::set(int v, int a)
         for (int u : adj[v])
             if (x[u] < 0)
             {
-                x[u] = 1;
+                remove_vertex(u, 1);
                 crt++;
                 vRestore[--rn] = u;
             }
@@ -202,11 +214,11 @@ void branch_and_reduce_algorithm::compute_fold(std::vector<int> const &S, std::v
     assert(NS.size() == S.size() + 1);
 
     // remove all vertices but the 1. neighbour
-    std::vector<int> removed(S.size() * 2);
+    int removedBegin = modVertices.size();
     for (unsigned int i = 0; i < S.size(); i++)
-        removed[i] = S[i];
+        modVertices.push_back(S[i]);
     for (unsigned int i = 0; i < S.size(); i++)
-        removed[S.size() + i] = NS[1 + i];
+        modVertices.push_back(NS[1 + i]);
 
     // s = first neighbour
     int s = NS[0];
@@ -227,14 +239,13 @@ void branch_and_reduce_algorithm::compute_fold(std::vector<int> const &S, std::v
     // tmp contains N(N(S))\S
 
     // set edges of s
-    std::vector<std::vector<int>> newAdj(p + 1);
-    {
-        std::vector<int> copyOfTmp(tmp.begin(), tmp.begin() + p);
-        newAdj[0].swap(copyOfTmp);
-    }
-    std::sort(newAdj[0].begin(), newAdj[0].end());
-    std::vector<int> vs(p + 1);
-    vs[0] = s;
+    dyn_csr::position top = adj.top();
+    std::sort(tmp.begin(), tmp.begin() + p);
+    dyn_csr::slot sAdj = adj.append(tmp.data(), p);
+    int vsBegin = modVertices.size();
+    int adjBegin = modAdj.size();
+    modVertices.push_back(s);
+    modAdj.push_back(sAdj);
     used.clear();
     for (int v : S)
         used.add(v);
@@ -242,9 +253,9 @@ void branch_and_reduce_algorithm::compute_fold(std::vector<int> const &S, std::v
         used.add(v);
 
     // set edges of vertices in tmp
-    for (unsigned int i = 0; i < newAdj[0].size(); i++)
+    for (int i = 0; i < sAdj.size; i++)
     {
-        int v = newAdj[0][i];
+        int v = sAdj.b[i];
         p = 0;
         bool add = false;
         for (int u : adj[v])
@@ -259,34 +270,11 @@ void branch_and_reduce_algorithm::compute_fold(std::vector<int> const &S, std::v
             }
         if (!add)
             tmp[p++] = s;
-        vs[1 + i] = v;
-
-        {
-            std::vector<int> copyOfTmp(tmp.begin(), tmp.begin() + p);
-            newAdj[i + 1].swap(copyOfTmp);
-        }
+        modVertices.push_back(v);
+        modAdj.push_back(adj.append(tmp.data(), p));
     }
 
-    modifieds[modifiedN++] = make_shared<fold>(fold(S.size(), removed, vs, newAdj, this));
-
-    // dependency checking
-    if (USE_DEPENDENCY_CHECKING) {
-        for (int v : vs) {
-            dc_candidates.Insert(v);
-
-            for (int vv : adj[v]) {
-                dc_candidates.Insert(vv);
-            }
-        }
-
-        for (int v : removed) {
-            dc_candidates.Insert(v);
-
-            for (int vv : adj[v]) {
-                dc_candidates.Insert(vv);
-            }
-        }
-    }
+    push_modified(modified::FOLD, S.size(), 0, removedBegin, vsBegin, adjBegin, top);
 }
 
 void branch_and_reduce_algorithm::compute_alternative(std::vector<int> const &A, std::vector<int> const &B)
@@ -331,23 +319,20 @@ void branch_and_reduce_algorithm::compute_alternative(std::vector<int> const &A,
     std::sort(B2.begin(), B2.end());
     // B2 contains v in N(B)\(A and N(A))
 
-    std::vector<int> removed(A.size() + B.size());
-    for (unsigned int i = 0; i < A.size(); i++)
-        removed[i] = A[i];
-    for (unsigned int i = 0; i < B.size(); i++)
-        removed[A.size() + i] = B[i];
-    std::vector<int> vs(A2.size() + B2.size());
-    for (unsigned int i = 0; i < A2.size(); i++)
-        vs[i] = A2[i];
-    for (unsigned int i = 0; i < B2.size(); i++)
-        vs[A2.size() + i] = B2[i];
-    std::vector<std::vector<int>> newAdj(vs.size());
+    int removedBegin = modVertices.size();
+    modVertices.insert(modVertices.end(), A.begin(), A.end());
+    modVertices.insert(modVertices.end(), B.begin(), B.end());
+    int vsBegin = modVertices.size();
+    modVertices.insert(modVertices.end(), A2.begin(), A2.end());
+    modVertices.insert(modVertices.end(), B2.begin(), B2.end());
+    dyn_csr::position top = adj.top();
+    int adjBegin = modAdj.size();
     used.clear();
     for (int a : A)
         used.add(a);
     for (int b : B)
         used.add(b);
-    for (unsigned int i = 0; i < vs.size(); i++)
+    for (unsigned int i = 0; i < A2.size() + B2.size(); i++)
     {
         unsigned int v = (i < A2.size()) ? A2[i] : B2[i - A2.size()];
         std::vector<int> const &C = (i < A2.size()) ? B2 : A2;
@@ -372,54 +357,202 @@ void branch_and_reduce_algorithm::compute_alternative(std::vector<int> const &A,
             else
                 tmp[p++] = C[q++];
         }
-        {
-            std::vector<int> copyOfTmp(tmp.begin(), tmp.begin() + p);
-            newAdj[i].swap(copyOfTmp);
-        }
+        modAdj.push_back(adj.append(tmp.data(), p));
     }
 
-    modifieds[modifiedN++] = make_shared<alternative>(alternative(removed.size() / 2, removed, vs, newAdj, this, A2.size()));
-
-    if (USE_DEPENDENCY_CHECKING) {
-        for (int v : removed) {
-            for (int n : adj[v]) {
-                dc_candidates.Insert(n);
-            }
-        }
-
-        for (int v : vs) {
-            dc_candidates.Insert(v);
-            for (int n : adj[v]) {
-                dc_candidates.Insert(n);
-            }
-        }
-    }
+    push_modified(modified::ALTERNATIVE, A.size(), A2.size(), removedBegin, vsBegin, adjBegin, top);
 }
 
 void branch_and_reduce_algorithm::restore(int n)
 {
     while (rn < n)
     {
+        // lists compacted while vRestore[rn] was already removed have to go first
+        while (!adjTrail.empty() && adjTrail.back().rn <= rn)
+            undo_compact();
         int v = vRestore[rn];
         if (v >= 0)
         {
             crt -= x[v];
-            x[v] = -1;
+            restore_vertex(v);
             rn++;
         }
         else
         {
-            modifieds[--modifiedN]->restore();
-            modifieds[modifiedN] = shared_ptr<modified>();
+            restore_modified();
+        }
+    }
+}
+
+// replaces the list of v by a copy without removed vertices, the order of the neighbours is kept
+void branch_and_reduce_algorithm::compact_list(int v)
+{
+    std::vector<int> &tmp = modTmp;
+    int p = 0;
+    for (int u : adj[v])
+        if (x[u] < 0)
+            tmp[p++] = u;
+    assert(p == deg(v));
+    adjTrail.push_back({v, adj.get(v), rn, adj.top()});
+    adj.set(v, adj.append(tmp.data(), p));
+}
+
+// compacts the lists that mostly consist of removed vertices
+void branch_and_reduce_algorithm::compact_dead_lists()
+{
+    for (int v : liveSet)
+    {
+        int size = adj[v].size();
+        if (size > 8 && liveDeg[v] < size * COMPACT)
+            compact_list(v);
+    }
+}
+
+void branch_and_reduce_algorithm::undo_compact()
+{
+    adj_change const &c = adjTrail.back();
+    adj.set(c.v, c.old);
+    adj.release(c.top);
+    adjTrail.pop_back();
+}
+
+void branch_and_reduce_algorithm::relabel(relabeling &r)
+{
+    std::vector<int> id(n);
+    r.oldId.resize(n);
+    int live = 0, dead = rn;
+    for (int v = 0; v < n; v++)
+    {
+        id[v] = x[v] < 0 ? live++ : dead++;
+        r.oldId[id[v]] = v;
+    }
+
+    // the removed vertices keep their lists, the subtree never restores them
+    r.top = adj.top();
+    r.lists.resize(n);
+    std::vector<int> &tmp = modTmp;
+    for (int v = 0; v < n; v++)
+    {
+        if (x[v] >= 0)
+        {
+            r.lists[id[v]] = adj.get(v);
+            continue;
         }
+        int p = 0;
+        for (int u : adj[v])
+            if (x[u] < 0)
+                tmp[p++] = id[u];
+        r.lists[id[v]] = adj.append(tmp.data(), p);
+    }
+    adj.swap_slots(r.lists);
+
+    renumber(id);
+    r.denseN = denseN;
+    denseN = rn;
+}
+
+void branch_and_reduce_algorithm::undo_relabel(relabeling &r)
+{
+    renumber(r.oldId);
+    adj.swap_slots(r.lists);
+    adj.release(r.top);
+    denseN = r.denseN;
+}
+
+// maps every vertex id v < n held by the solver to id[v], except for the adjacency lists
+void branch_and_reduce_algorithm::renumber(std::vector<int> const &id)
+{
+    auto map = [&](int &v) {
+        if (v >= 0 && v < n)
+            v = id[v];
+    };
+    // a[id[v]] = a[v]
+    auto move = [&](auto &a) {
+        typename std::remove_reference<decltype(a)>::type b(a.size());
+        for (int v = 0; v < static_cast<int>(a.size()); v++)
+            b[v < n ? id[v] : v] = std::move(a[v]);
+        a.swap(b);
+    };
+
+    move(x);
+    move(y);
+    move(liveDeg);
+    move(in);
+    move(out);
+    for (int &v : in)
+        map(v);
+    for (int &v : out)
+        map(v);
+    for (int &v : vRestore)
+        map(v);
+    for (int &v : modVertices)
+        map(v);
+    for (adj_change &c : adjTrail)
+        map(c.v);
+    for (std::vector<int> &ps : packing)
+        for (unsigned int j = 1; j < ps.size(); j++) // ps[0] is no vertex
+            map(ps[j]);
+
+    // the orders within the buckets and of liveSet stay the same, so ties are broken as before
+    std::vector<int> &tmp = modTmp;
+    degree_buckets buckets(n);
+    for (int d = degBuckets.max(); d >= 0; d--)
+    {
+        int k = 0;
+        for (int v = degBuckets.first(d); v >= 0; v = degBuckets.succ(v))
+            tmp[k++] = v;
+        while (k > 0)
+            buckets.insert(id[tmp[--k]], d);
+    }
+    std::swap(degBuckets, buckets);
+    ArraySet live(n);
+    for (int v : liveSet)
+        live.Insert(id[v]);
+    std::swap(liveSet, live);
+
+    // the cached evaluation of the model has vertex ids as row ids
+    gcnMark.clear();
+    gcnChanged.clear();
+
+    // branching rules
+    for (std::vector<int> *vs : {&nd_order, &separator, &cut, &artics, &b_vtcs, &domin_vtcs,
+                                 &unconf_vtcs, &twin_vtcs, &funnel_vtcs, &packing_vtcs})
+        for (int &v : *vs)
+            map(v);
+    map(s);
+    map(t);
+    map(vertexOne);
+    move(partition_index);
+    if (articulation_points.size() == static_cast<size_t>(n))
+        move(articulation_points);
+
+    // dependency checking
+    move(packingMap);
+    move(foldingMap);
+    for (std::vector<int> &f : foldingMap)
+        for (int &v : f)
+            map(v);
+    if (config.USE_DEPENDENCY_CHECKING)
+    {
+        std::vector<int> candidates(dc_candidates.begin(), dc_candidates.end());
+        dc_candidates.Clear();
+        for (int v : candidates)
+            dc_candidates.Insert(v < n ? id[v] : v);
     }
+    std::vector<int> checked;
+    for (int v = 0; v < N; v++)
+        if (candidatesChecked.get(v))
+            checked.push_back(v < n ? id[v] : v);
+    candidatesChecked.clear();
+    for (int v : checked)
+        candidatesChecked.add(v);
 }
 
 void branch_and_reduce_algorithm::reverse()
 {
     for (int i = modifiedN - 1; i >= 0; i--)
     {
-        modifieds[i]->reverse(y);
+        reverse_modified(modifieds[i], y);
     }
 }
 
@@ -434,12 +567,13 @@ int branch_and_reduce_algorithm::cycleLowerBound()
 {
     int lb = crt;
     std::vector<int> &id = iter;
-    for (int i = 0; i < n; i++)
+    std::vector<int> remaining = remaining_vertices();
+    for (int i : remaining)
         id[i] = -1;
     std::vector<int> &pos = que;
     std::vector<int> &S = level;
     std::vector<int> &S2 = modTmp;
-    for (int i = 0; i < n; i++)
+    for (int i : remaining)
         if (x[i] < 0 && id[i] < 0)
         {
             int v = i;
@@ -538,9 +672,8 @@ int branch_and_reduce_algorithm::cliqueLowerBound()
     int need = crt;
     std::vector<long long> ls(rn, 0);
     int k = 0;
-    for (int i = 0; i < n; i++)
-        if (x[i] < 0)
-            ls[k++] = ((long long)deg(i)) << 32 | i;
+    for (int i : liveSet)
+        ls[k++] = ((long long)deg(i)) << 32 | i;
     std::sort(ls.begin(), ls.end());
     std::vector<int> &clique = que;
     std::vector<int> &size = level;
@@ -587,7 +720,7 @@ int branch_and_reduce_algorithm::lowerBound()
         lb = crt;
         type = 1;
     }
-    if (LOWER_BOUND == 1 || LOWER_BOUND == 4)
+    if (config.LOWER_BOUND == 1 || config.LOWER_BOUND == 4)
     {
         tmp = cliqueLowerBound();
         if (lb < tmp)
@@ -596,7 +729,7 @@ int branch_and_reduce_algorithm::lowerBound()
             type = 4;
         }
     }
-    if (LOWER_BOUND == 2 || LOWER_BOUND == 4)
+    if (config.LOWER_BOUND == 2 || config.LOWER_BOUND == 4)
     {
         tmp = lpLowerBound();
         if (lb < tmp)
@@ -605,7 +738,7 @@ int branch_and_reduce_algorithm::lowerBound()
             type = 2;
         }
     }
-    if (LOWER_BOUND == 3 || LOWER_BOUND == 4)
+    if (config.LOWER_BOUND == 3 || config.LOWER_BOUND == 4)
     {
         tmp = cycleLowerBound();
         if (lb < tmp)
@@ -614,7 +747,7 @@ int branch_and_reduce_algorithm::lowerBound()
             type = 3;
         }
     }
-    if (debug >= 2 && depth <= maxDepth)
+    if (config.debug >= 2 && depth <= maxDepth)
         fprintf(stderr, "%slb: %d (%d), %d\n", debugString().c_str(), lb, type, opt);
     return lb;
 }
@@ -641,18 +774,27 @@ bool branch_and_reduce_algorithm::dinicDFS(int v)
 void branch_and_reduce_algorithm::updateLP()
 {
 #if 1
-    for (int v = 0; v < n; v++)
-        if (out[v] >= 0 && ((x[v] < 0) ^ (x[out[v]] < 0)))
+    // drop matching edges between a remaining and a removed vertex
+    std::vector<int> remaining = remaining_vertices();
+    for (int v : remaining)
+    {
+        if (out[v] >= 0 && x[out[v]] >= 0)
         {
             in[out[v]] = -1;
             out[v] = -1;
         }
+        if (in[v] >= 0 && x[in[v]] >= 0)
+        {
+            out[in[v]] = -1;
+            in[v] = -1;
+        }
+    }
     for (;;)
     {
         used.clear();
         int qs = 0, qt = 0;
-        for (int v = 0; v < n; v++)
-            if (x[v] < 0 && out[v] < 0)
+        for (int v : remaining)
+            if (out[v] < 0)
             {
                 level[v] = 0;
                 used.add(v);
@@ -679,10 +821,10 @@ void branch_and_reduce_algorithm::updateLP()
         }
         if (!ok)
             break;
-        for (int v = n - 1; v >= 0; v--)
-            if (x[v] < 0 && out[v] < 0)
+        for (int i = remaining.size() - 1; i >= 0; i--)
+            if (out[remaining[i]] < 0)
             {
-                dinicDFS(v);
+                dinicDFS(remaining[i]);
             }
     }
 
@@ -697,15 +839,17 @@ bool branch_and_reduce_algorithm::lpReduction()
     updateLP();
 
 #if 1
-    for (int v = 0; v < n; v++)
+    std::vector<int> remaining = remaining_vertices();
+    for (int v : remaining)
     {
         if (x[v] < 0 && used.get(v) && !used.get(n + v))
             set(v, 0);
     }
     used.clear();
     int p = 0;
-    iter.assign(iter.size(), 0);
-    for (int s = 0; s < n; s++)
+    for (int v : remaining)
+        iter[v] = 0;
+    for (int s : remaining)
         if (x[s] < 0 && used.add(s))
         {
             int qt = 0;
@@ -779,7 +923,7 @@ bool branch_and_reduce_algorithm::lpReduction()
         }
 
 #endif // 0
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sLP: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -790,7 +934,7 @@ bool branch_and_reduce_algorithm::deg1Reduction_dc()
     std::vector<int> &deg = iter;
     int qt = 0;
     used.clear();
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             deg[v] = n == rn ? adj[v].size() : this->deg(v);
@@ -819,7 +963,7 @@ bool branch_and_reduce_algorithm::deg1Reduction_dc()
             }
         set(v, 0);
     }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sdeg1: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -830,7 +974,7 @@ bool branch_and_reduce_algorithm::deg1Reduction()
     std::vector<int> &deg = iter;
     int qt = 0;
     used.clear();
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             deg[v] = n == rn ? adj[v].size() : this->deg(v);
@@ -859,7 +1003,7 @@ bool branch_and_reduce_algorithm::deg1Reduction()
             }
         set(v, 0);
     }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sdeg1: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -868,7 +1012,7 @@ bool branch_and_reduce_algorithm::dominateReduction()
 {
     int oldn = rn;
 #if 1
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             used.clear();
@@ -903,7 +1047,7 @@ bool branch_and_reduce_algorithm::dominateReduction()
                 loop:;
                 }
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sdominate: %d -> %d\n", debugString().c_str(), oldn, rn);
 #endif // 0
     return oldn != rn;
@@ -912,7 +1056,7 @@ bool branch_and_reduce_algorithm::dominateReduction()
 bool branch_and_reduce_algorithm::almost_dominated()
 {
     bool found = false;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             used.clear();
@@ -948,7 +1092,7 @@ bool branch_and_reduce_algorithm::fold2Reduction_dc()
 {
     int oldn = rn;
     std::vector<int> &tmp = level;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0 && dc_candidates.Contains(v))
         {
             int p = 0;
@@ -973,7 +1117,7 @@ bool branch_and_reduce_algorithm::fold2Reduction_dc()
             }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sfold2: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -982,7 +1126,7 @@ bool branch_and_reduce_algorithm::fold2Reduction()
 {
     int oldn = rn;
     std::vector<int> &tmp = level;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             int p = 0;
@@ -1007,7 +1151,7 @@ bool branch_and_reduce_algorithm::fold2Reduction()
             }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sfold2: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -1018,9 +1162,10 @@ bool branch_and_reduce_algorithm::twinReduction_dc()
     std::vector<int> &vUsed = iter;
     int uid = 0;
     std::vector<int> NS(3, 0);
-    for (int i = 0; i < n; i++)
+    std::vector<int> remaining = remaining_vertices();
+    for (int i : remaining)
         vUsed[i] = 0;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining)
         if (x[v] < 0 && dc_candidates.Contains(v) && deg(v) == 3)
         {
             int p = 0;
@@ -1056,10 +1201,10 @@ bool branch_and_reduce_algorithm::twinReduction_dc()
                                         set(v, 0);
                                         set(w, 0);
                                     }
-                                    //cout << "twin: " << nBranchings << endl;
+                                    //cout << "twin: " << stats->nBranchings << endl;
                                     goto loop;
                                 }
-                                else if ((BRANCHING == 6 || BRANCHING == 9 || BRANCHING == 11 || BRANCHING == 31) && p == 3 && deg(w) == 4)
+                                else if ((config.BRANCHING == 6 || config.BRANCHING == 9 || config.BRANCHING == 11 || config.BRANCHING == 31) && p == 3 && deg(w) == 4)
                                 {
                                     for (int z : adj[w])
                                     {
@@ -1075,7 +1220,7 @@ bool branch_and_reduce_algorithm::twinReduction_dc()
                 }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%stwin: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -1086,9 +1231,10 @@ bool branch_and_reduce_algorithm::twinReduction()
     std::vector<int> &vUsed = iter;
     int uid = 0;
     std::vector<int> NS(3, 0);
-    for (int i = 0; i < n; i++)
+    std::vector<int> remaining = remaining_vertices();
+    for (int i : remaining)
         vUsed[i] = 0;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining)
         if (x[v] < 0 && deg(v) == 3)
         {
             int p = 0;
@@ -1124,10 +1270,10 @@ bool branch_and_reduce_algorithm::twinReduction()
                                         set(v, 0);
                                         set(w, 0);
                                     }
-                                    //cout << "twin: " << nBranchings << endl;
+                                    //cout << "twin: " << stats->nBranchings << endl;
                                     goto loop;
                                 }
-                                else if ((BRANCHING == 6 || BRANCHING == 9 || BRANCHING == 11 || BRANCHING == 31) && p == 3 && deg(w) == 4)
+                                else if ((config.BRANCHING == 6 || config.BRANCHING == 9 || config.BRANCHING == 11 || config.BRANCHING == 31) && p == 3 && deg(w) == 4)
                                 {
                                     for (int z : adj[w])
                                     {
@@ -1143,18 +1289,18 @@ bool branch_and_reduce_algorithm::twinReduction()
                 }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%stwin: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
 
 bool branch_and_reduce_algorithm::funnelReduction_dc()
 {
-    if (BRANCHING == 7 || BRANCHING == 9 || BRANCHING == 11 || BRANCHING == 31)
+    if (config.BRANCHING == 7 || config.BRANCHING == 9 || config.BRANCHING == 11 || config.BRANCHING == 31)
         return funnelReduction_a_dc();
 
     int oldn = rn;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0 && dc_candidates.Contains(v))
         {
             used.clear();
@@ -1236,18 +1382,18 @@ bool branch_and_reduce_algorithm::funnelReduction_dc()
             }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sfunnel: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
 
 bool branch_and_reduce_algorithm::funnelReduction()
 {
-    if (BRANCHING == 7 || BRANCHING == 9 || BRANCHING == 11 || BRANCHING == 31)
+    if (config.BRANCHING == 7 || config.BRANCHING == 9 || config.BRANCHING == 11 || config.BRANCHING == 31)
         return funnelReduction_a();
 
     int oldn = rn;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             used.clear();
@@ -1329,7 +1475,7 @@ bool branch_and_reduce_algorithm::funnelReduction()
             }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sfunnel: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -1409,7 +1555,7 @@ bool branch_and_reduce_algorithm::checkFunnel(int v)
 bool branch_and_reduce_algorithm::funnelReduction_a()
 {
     int oldn = rn;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             used.clear();
@@ -1515,7 +1661,7 @@ bool branch_and_reduce_algorithm::funnelReduction_a()
                             if (checkFunnel(v))
                             {
                                 x[i] = -1;
-                                if (BRANCHING == 31) 
+                                if (config.BRANCHING == 31) 
                                     funnel_vtcs.push_back(i);
                                 else 
                                     b_vtcs.push_back(i);
@@ -1527,7 +1673,7 @@ bool branch_and_reduce_algorithm::funnelReduction_a()
             }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sfunnel: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -1535,7 +1681,7 @@ bool branch_and_reduce_algorithm::funnelReduction_a()
 bool branch_and_reduce_algorithm::funnelReduction_a_dc()
 {
     int oldn = rn;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0 && dc_candidates.Contains(v))
         {
             used.clear();
@@ -1641,7 +1787,7 @@ bool branch_and_reduce_algorithm::funnelReduction_a_dc()
                             if (checkFunnel(v))
                             {
                                 x[i] = -1;
-                                if (BRANCHING == 31) 
+                                if (config.BRANCHING == 31) 
                                     funnel_vtcs.push_back(i);
                                 else 
                                     b_vtcs.push_back(i);
@@ -1653,7 +1799,7 @@ bool branch_and_reduce_algorithm::funnelReduction_a_dc()
             }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sfunnel: %d -> %d\n", debugString().c_str(), oldn, rn);
     return oldn != rn;
 }
@@ -1664,9 +1810,10 @@ bool branch_and_reduce_algorithm::deskReduction()
 #if 1
     std::vector<int> &tmp = level;
     std::vector<int> &nv = iter;
-    for (int i = 0; i < n; i++)
+    std::vector<int> remaining = remaining_vertices();
+    for (int i : remaining)
         nv[i] = -1;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining)
         if (x[v] < 0)
         {
             int d = 0;
@@ -1724,7 +1871,7 @@ bool branch_and_reduce_algorithm::deskReduction()
                                         if (sA <= 2)
                                         {
                                             compute_alternative(std::vector<int>{v, w}, std::vector<int>{u1, u2});
-                                            //std::cout << "desk: " << nBranchings << endl;
+                                            //std::cout << "desk: " << stats->nBranchings << endl;
                                             goto loop;
                                         }
                                     }
@@ -1735,7 +1882,7 @@ bool branch_and_reduce_algorithm::deskReduction()
             }
         loop:;
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sdesk: %d -> %d\n", debugString().c_str(), oldn, rn);
 #endif // 0
     return oldn != rn;
@@ -1743,14 +1890,14 @@ bool branch_and_reduce_algorithm::deskReduction()
 
 bool branch_and_reduce_algorithm::unconfinedReduction()
 {
-    if (BRANCHING == 8 || BRANCHING == 9 || BRANCHING == 11 || (BRANCHING == 31 && TUNING_PARAM3 == 1))
+    if (config.BRANCHING == 8 || config.BRANCHING == 9 || config.BRANCHING == 11 || (config.BRANCHING == 31 && config.TUNING_PARAM3 == 1))
         return unconfinedReduction_a();
 
     int oldn = rn;
 #if 1
     std::vector<int> &NS = level;
     std::vector<int> &deg = iter;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             used.clear();
@@ -1788,7 +1935,7 @@ bool branch_and_reduce_algorithm::unconfinedReduction()
                         }
                     if (z == -1)
                     {
-                        if (REDUCTION >= 3)
+                        if (config.REDUCTION >= 3)
                         {
                             std::vector<int> &qs = que;
                             int q = 0;
@@ -1870,7 +2017,7 @@ bool branch_and_reduce_algorithm::unconfinedReduction()
                         for (int j = i + 1; j < size; j++)
                             if (vs[i] == vs[j] && vs[n + i] == vs[n + j] && !used.get(NS[j]))
                             {
-                                if (REDUCTION >= 3)
+                                if (config.REDUCTION >= 3)
                                 {
                                     std::vector<int> &qs = que;
                                     int q = 0;
@@ -1888,7 +2035,7 @@ bool branch_and_reduce_algorithm::unconfinedReduction()
             forloopend:;
             }
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sunconfined: %d -> %d\n", debugString().c_str(), oldn, rn);
 #endif //0
     return oldn != rn;
@@ -1900,7 +2047,7 @@ bool branch_and_reduce_algorithm::unconfinedReduction_a()
 #if 1
     std::vector<int> &NS = level;
     std::vector<int> &deg = iter;
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             used.clear();
@@ -1940,7 +2087,7 @@ bool branch_and_reduce_algorithm::unconfinedReduction_a()
                         }
                     if (z == -1) // u is child with N(u)\N(S) = 0
                     {
-                        if (REDUCTION >= 3)
+                        if (config.REDUCTION >= 3)
                         {
                             std::vector<int> &qs = que;
                             int q = 0;
@@ -1966,7 +2113,7 @@ bool branch_and_reduce_algorithm::unconfinedReduction_a()
                     {
                         // unconf_vtcs.push_back(extends[0]);
                         int vtx = extends[0];
-                        if (BRANCHING == 31) unconf_vtcs.push_back(vtx);
+                        if (config.BRANCHING == 31) unconf_vtcs.push_back(vtx);
                         else b_vtcs.push_back(vtx);
                     }
                     int z = extends[0];
@@ -2035,7 +2182,7 @@ bool branch_and_reduce_algorithm::unconfinedReduction_a()
                         for (int j = i + 1; j < size; j++)
                             if (vs[i] == vs[j] && vs[n + i] == vs[n + j] && !used.get(NS[j]))
                             {
-                                if (REDUCTION >= 3)
+                                if (config.REDUCTION >= 3)
                                 {
                                     std::vector<int> &qs = que;
                                     int q = 0;
@@ -2053,7 +2200,7 @@ bool branch_and_reduce_algorithm::unconfinedReduction_a()
             forloopend:;
             }
         }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sunconfined: %d -> %d\n", debugString().c_str(), oldn, rn);
 #endif //0
     return oldn != rn;
@@ -2063,7 +2210,7 @@ void inline branch_and_reduce_algorithm::pushPacking(std::vector<int> &pack)
 {
     packing.emplace_back(std::move(pack));
 
-    if (USE_DEPENDENCY_CHECKING) {
+    if (config.USE_DEPENDENCY_CHECKING) {
         int nPack = packing.size() - 1;
         std::vector<int> &pck = packing.back();
         for (int i = 1; i < pck.size(); i++) {
@@ -2076,7 +2223,7 @@ void inline branch_and_reduce_algorithm::pushPacking(std::vector<int> &pack)
 
 void inline branch_and_reduce_algorithm::popPacking() 
 {
-    if (USE_DEPENDENCY_CHECKING) {
+    if (config.USE_DEPENDENCY_CHECKING) {
         int nPack = packing.size() - 1;
         std::vector<int> &pck = packing.back();
         for (int i = 1; i < pck.size(); i++) {
@@ -2107,7 +2254,7 @@ int branch_and_reduce_algorithm::packingReduction_dc()
                     x2[j] = x[j];
                 for (int j = modifiedN - 1; j >= 0; j--)
                 {
-                    modifieds[j]->reverse(x2);
+                    reverse_modified(modifieds[j], x2);
                 }
                 a = rn;
             }
@@ -2172,7 +2319,7 @@ int branch_and_reduce_algorithm::packingReduction_dc()
                 }
                 for (int j = 0; j < size; j++) // set x[v] = 0 for remaining vtcs
                 {
-                    if (S[j] == 1)
+                    if (S[j] == vertexOne)
                         return -1;
                     assert(x[S[j]] < 0);
                     set(S[j], 0);
@@ -2211,13 +2358,13 @@ int branch_and_reduce_algorithm::packingReduction_dc()
                             set(v, 1);
                             break;
                         }
-                        else if (BRANCHING == 10 || BRANCHING == 11 || BRANCHING == 31)
+                        else if (config.BRANCHING == 10 || config.BRANCHING == 11 || config.BRANCHING == 31)
                         {
                             if ((sum + 1 + p) > max)
                             {
                                 for (int i = 0; i < size; i++)
                                     if (count[S[i]] == -1) {
-                                        if (BRANCHING == 31) packing_vtcs.push_back(S[i]);
+                                        if (config.BRANCHING == 31) packing_vtcs.push_back(S[i]);
                                         else b_vtcs.push_back(S[i]);
                                     }
                             }
@@ -2225,11 +2372,11 @@ int branch_and_reduce_algorithm::packingReduction_dc()
                     }
             }
 
-            if (BRANCHING == 10 || BRANCHING == 11 | BRANCHING == 31)
+            if (config.BRANCHING == 10 || config.BRANCHING == 11 | config.BRANCHING == 31)
             {
                 if (sum == (max - 1) && size > 1)
                 {
-                    if (BRANCHING == 31) {
+                    if (config.BRANCHING == 31) {
                         for (int i = 0; i < size; i++) {
                             packing_vtcs.push_back(S[i]);
                         }
@@ -2242,7 +2389,7 @@ int branch_and_reduce_algorithm::packingReduction_dc()
             }
         }
     }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%spacking: %d -> %d\n", debugString().c_str(), oldn, rn);
 #endif // 0
     return oldn != rn ? 1 : 0;
@@ -2263,7 +2410,7 @@ int branch_and_reduce_algorithm::packingReduction()
                 x2[j] = x[j];
             for (int j = modifiedN - 1; j >= 0; j--)
             {
-                modifieds[j]->reverse(x2);
+                reverse_modified(modifieds[j], x2);
             }
             a = rn;
         }
@@ -2272,7 +2419,7 @@ int branch_and_reduce_algorithm::packingReduction()
         for (unsigned int j = 1; j < ps.size(); j++)
         {
             int v = ps[j];
-            assert(!USE_DEPENDENCY_CHECKING || std::find(packingMap[v].begin(), packingMap[v].end(), pi) != packingMap[v].end());
+            assert(!config.USE_DEPENDENCY_CHECKING || std::find(packingMap[v].begin(), packingMap[v].end(), pi) != packingMap[v].end());
             if (x2[v] < 0)
                 S[size++] = v;
             if (x2[v] == 1)
@@ -2329,7 +2476,7 @@ int branch_and_reduce_algorithm::packingReduction()
             }
             for (int j = 0; j < size; j++) // set x[v] = 0 for remaining vtcs
             {
-                if (S[j] == 1)
+                if (S[j] == vertexOne)
                     return -1;
                 assert(x[S[j]] < 0);
                 set(S[j], 0);
@@ -2368,13 +2515,13 @@ int branch_and_reduce_algorithm::packingReduction()
                         set(v, 1);
                         break;
                     }
-                    else if (BRANCHING == 10 || BRANCHING == 11 || BRANCHING == 31)
+                    else if (config.BRANCHING == 10 || config.BRANCHING == 11 || config.BRANCHING == 31)
                     {
                         if ((sum + 1 + p) > max)
                         {
                             for (int i = 0; i < size; i++)
                                 if (count[S[i]] == -1) {
-                                    if (BRANCHING == 31) packing_vtcs.push_back(S[i]);
+                                    if (config.BRANCHING == 31) packing_vtcs.push_back(S[i]);
                                     else b_vtcs.push_back(S[i]);
                                 }
                         }
@@ -2382,11 +2529,11 @@ int branch_and_reduce_algorithm::packingReduction()
                 }
         }
 
-        if (BRANCHING == 10 || BRANCHING == 11 | BRANCHING == 31)
+        if (config.BRANCHING == 10 || config.BRANCHING == 11 | config.BRANCHING == 31)
         {
             if (sum == (max - 1) && size > 1)
             {
-                if (BRANCHING == 31) {
+                if (config.BRANCHING == 31) {
                     for (int i = 0; i < size; i++) {
                         packing_vtcs.push_back(S[i]);
                     }
@@ -2398,85 +2545,451 @@ int branch_and_reduce_algorithm::packingReduction()
             }
         }
     }
-    if (debug >= 3 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 3 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%spacking: %d -> %d\n", debugString().c_str(), oldn, rn);
 #endif // 0
     return oldn != rn ? 1 : 0;
 }
 
-void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
+thread_pool *branch_and_reduce_algorithm::shared_pool(solver_config const &config)
 {
-    int oldLB = lb;
-    int v = -1, dv = 0;
-    std::vector<int> &mirrors = que;
-    int mirrorN = 0;
-
-    debug_info deb_info;
-    deb_info.type = info_type::Branching;
-    deb_info.depth = depth;
-    deb_info.rn = rn;
+    if (config.THREADS == 1)
+        return nullptr;
+    int threads = config.THREADS;
+    thread_pool &pool = thread_pool::shared(threads > 0 ? threads : std::thread::hardware_concurrency());
+    return pool.size() > 1 ? &pool : nullptr;
+}
 
-    if (BRANCHING == 0) // branch on random vertex
+// runs f for a solver on a pool thread, gcn_eval needs buffers of its own there
+template <typename F>
+static void with_own_gcn_data(branch_and_reduce_algorithm *vc, F f)
+{
+    if (vc->config.BRANCHING != 14)
     {
-        int p = rand() % rn;
-        for (int i = 0; i < n; i++)
-            if (x[i] < 0 && p-- == 0)
-                v = i;
-        dv = deg(v);
+        f();
+        return;
     }
-    else if (BRANCHING == 1) // branch on vertex with min. deg.
+    long m = 0;
+    for (int v = 0; v < vc->n; v++)
+        m += vc->adj[v].size();
+    int *V = (int *)malloc(sizeof(int) * vc->N * 2);
+    int *E = (int *)malloc(sizeof(int) * (m * 2 + 1));
+    vc->model_data = gcn_data_init(vc->model, vc->N * 2, V, E, branch_and_reduce_algorithm::shared_pool(vc->config));
+    f();
+    gcn_data_free(vc->model_data);
+    free(V);
+    free(E);
+}
+
+void branch_and_reduce_algorithm::share_opt()
+{
+    if (!sharedOpt)
+        return;
+    int best = *sharedOpt;
+    while (opt < best && !sharedOpt->compare_exchange_weak(best, opt))
+        ;
+}
+
+// copy of the current node whose search runs on its own, it never restores anything that
+// was removed before the fork, so the lists are copied as they are and the undo trails are dropped
+branch_and_reduce_algorithm *branch_and_reduce_algorithm::fork()
+{
+    if (!sharedOpt)
+        sharedOpt = std::make_shared<std::atomic<int>>(opt);
+
+    std::vector<long long> offsets(n + 1, 0);
+    for (int v = 0; v < n; v++)
+        offsets[v + 1] = offsets[v] + adj[v].size();
+    std::vector<int> nbr(offsets[n]);
+    for (int v = 0; v < n; v++)
+        std::copy(adj[v].begin(), adj[v].end(), nbr.begin() + offsets[v]);
+    dyn_csr adj2(offsets, nbr);
+
+    branch_and_reduce_algorithm *c = new branch_and_reduce_algorithm(adj2, N, config);
+    c->stats = stats;
+    c->SHRINK = SHRINK;
+    c->COMPACT = COMPACT;
+    c->SHRINK_COMPACT = SHRINK_COMPACT;
+    c->depth = depth;
+    c->maxDepth = maxDepth;
+    c->max_depth = max_depth;
+    c->rootDepth = rootDepth;
+    c->model = model;
+    c->model_data = model_data;
+    c->gcnRef = gcnRef;
+    c->logger = logger;
+    c->opt = opt;
+    c->y = y;
+    c->sharedOpt = sharedOpt;
+    c->outer = outer;
+    c->outerBase = outerBase;
+    c->cancel = cancel;
+    c->remote = remote;
+    c->crt = crt;
+    c->x = x;
+    c->liveDeg = liveDeg;
+    c->degBuckets = degBuckets;
+    c->liveSet = liveSet;
+    c->rn = rn;
+    c->in = in;
+    c->out = out;
+    c->lb = lb;
+    c->compactN = compactN;
+    c->denseN = denseN;
+    c->vertexOne = vertexOne;
+    c->modifieds = modifieds;
+    c->modifiedN = modifiedN;
+    c->modVertices = modVertices;
+    c->modAdj.assign(modAdj.size(), dyn_csr::slot{nullptr, 0});
+    c->packing = packing;
+    c->vRestore = vRestore;
+    c->reductionSnapshotSize = reductionSnapshotSize;
+    c->startingSolutionIsBest = startingSolutionIsBest;
+    c->nd_computed = nd_computed;
+    c->nd_order = nd_order;
+    c->separator = separator;
+    c->partition_index = partition_index;
+    c->perform_refinement = perform_refinement;
+    c->cut = cut;
+    c->s = s;
+    c->t = t;
+    c->branch_t = branch_t;
+    c->dc_candidates = dc_candidates;
+    c->packingMap = packingMap;
+    c->foldingMap = foldingMap;
+    c->packingCandidates = packingCandidates;
+    return c;
+}
+
+// sends the remaining graph to an idle worker process, which looks for a cover below cutoff(),
+// -1 if all workers are busy
+int branch_and_reduce_algorithm::submit_remote(timer &t, double time_limit)
+{
+    std::vector<int> vs = remaining_vertices();
+    std::vector<int> id(n, -1);
+    for (unsigned int i = 0; i < vs.size(); i++)
+        id[vs[i]] = i;
+    long long m = 0;
+    for (int v : vs)
+        m += deg(v);
+    assert(m < INT32_MAX - rn);
+
+    std::vector<int> data{cutoff() - crt, std::max(1, (int)(time_limit - t.elapsed())), rn, (int)m};
+    data.reserve(4 + rn + 1 + m);
+    data.push_back(0);
+    for (int v : vs)
+        data.push_back(data.back() + deg(v));
+    for (int v : vs)
+        for (int u : adj[v])
+            if (x[u] < 0)
+                data.push_back(id[u]);
+    return remote->submit(crt, sharedOpt, std::move(data));
+}
+
+// takes the result of submit_remote, false if the worker died and the subtree still has to be searched
+bool branch_and_reduce_algorithm::finish_remote(int task)
+{
+    int k;
+    long branchings, smallBranchings;
+    std::vector<int> cover;
+    if (task < 0 || !remote->wait(task, k, branchings, smallBranchings, cover))
+        return false;
+    stats->nBranchings += branchings;
+    stats->smallBranchings += smallBranchings;
+    if (cover.empty()) // no better cover in the subtree
+        return true;
+    std::vector<int> vs = remaining_vertices();
+    assert(cover.size() == vs.size());
+    opt = crt + k;
+    share_opt();
+    y = x;
+    for (unsigned int i = 0; i < vs.size(); i++)
+        y[vs[i]] = cover[i];
+    startingSolutionIsBest = false;
+    reverse();
+    return true;
+}
+
+// x[v] = 0 together with the packing constraints of the branch
+void branch_and_reduce_algorithm::exclude(int v, bool hasMirrors)
+{
+    if (!hasMirrors)
     {
-        dv = n + 1;
-        for (int u = 0; u < n; u++)
+        used.clear();
+        used.add(v);
+        for (int u : adj[v])
             if (x[u] < 0)
-            {
-                int degree = deg(u);
-                if (dv > degree)
+                used.add(u);
+        if (config.REDUCTION >= 3)
+        {
+            std::vector<int> ws(n, -1);
+            for (int u : adj[v])
+                if (x[u] < 0)
                 {
-                    v = u;
-                    dv = degree;
+                    std::vector<int> &tmp = level;
+                    int p = 0;
+                    tmp[p++] = 1;
+                    for (int w : adj[u])
+                        if (x[w] < 0 && !used.get(w))
+                        {
+                            tmp[p++] = w;
+                            ws[w] = u;
+                        }
+                    assert(p >= 2);
+                    for (int u2 : adj[tmp[1]])
+                        if (x[u2] < 0 && used.get(u2) && u2 != u)
+                        {
+                            int c = 0;
+                            for (int w : adj[u2])
+                                if (x[w] < 0)
+                                {
+                                    if (ws[w] == u)
+                                        c++;
+                                    else if (w == u || !used.get(w))
+                                    {
+                                        c = -1;
+                                        break;
+                                    }
+                                }
+                            if (c == p - 1)
+                            {
+                                tmp[0] = 2;
+                                break;
+                            }
+                        }
+                    std::vector<int> copyOfTmp(tmp.begin(), tmp.begin() + p);
+                    pushPacking(copyOfTmp);
                 }
-            }
-    }
-    else if (BRANCHING == 2) // branch on vertex with max. deg. && min. edges among N(v)
-    {
-        v = get_max_deg_vtx();
-        dv = deg(v);
+        }
     }
-    else if (BRANCHING == 3) // articulation points
-    {
-        while (!artics.empty() && x[artics.back()] != -1)
-            artics.pop_back();
+    set(v, 0);
+}
 
-        if (artics.empty())
+// vertex with the highest score of the model. While most of the graph remains, the rows of the model
+// are the vertex ids and the model reads adj itself, so the activations of the last evaluation stay
+// valid away from the vertices in gcnChanged and layer k only has to be evaluated again on the rows
+// within k + 1 hops of them
+int branch_and_reduce_algorithm::gcn_pick()
+{
+    if (rn * 4 < denseN) // evaluated from scratch on the remaining graph with ids 0, ..., rn - 1
+    {
+        if (new_id.size() < n)
         {
-            get_articulation_points_iteratively();
-            for (int i = 0; i < n; i++)
-                if (articulation_points[i] == 1 && x[i] < 0)
-                    artics.push_back(i);
-
-            if (artics.empty())
-            {
-                artics.push_back(get_max_deg_vtx());
-                defaultPicks++;
-                defaultBranch = true;
-            }
-            else
-            {
-                stratPicks++;
-            }
+            new_id.resize(n);
+            old_id.resize(n);
         }
-        else
+        
+        int next_label = 0;
+        
+        for (int i : remaining_vertices())
         {
-            stratPicks++;
+            new_id[i] = next_label;
+            old_id[next_label] = i;
+            next_label++;
         }
-
-        v = artics.back();
-        artics.pop_back();
-        dv = deg(v);
-    }
-    else if (BRANCHING == 4) // edge cuts
-    {
+        
+        model_data.N = next_label;
+        model_data.V[0] = 0;
+        
+        for (int i = 0; i < model_data.N; i++)
+        {
+            model_data.V[i + 1] = model_data.V[i];
+            for (int j : adj[old_id[i]])
+            {
+                if (x[j] < 0)
+                {
+                    model_data.E[model_data.V[i + 1]] = new_id[j];
+                    model_data.V[i + 1]++;
+                }
+            }
+        }
+        
+        gcn_eval(model, model_data);
+        
+        int best = 0;
+        for (int i = 1; i < model_data.N; i++)
+        {
+            if (model_data.y[i] > model_data.y[best])
+            {
+                best = i;
+            }
+        }
+        
+        return old_id[best];
+    }
+
+    int layers = model.hidden_layers + 2;
+    std::vector<std::vector<int>> rows(layers);
+    bool full = gcnMark.empty() || gcnChanged.size() * 8 > rn;
+    if (!full)
+    {
+        // vertices with a new degree or new neighbours: the changed ones and their neighbours. Lists
+        // only change with a touch of both ends and removed vertices keep their list, so adj[v] holds
+        // the old neighbours as well
+        used.clear();
+        for (int v : gcnChanged)
+        {
+            if (x[v] < 0 && used.add(v))
+                rows[0].push_back(v);
+            for (int u : adj[v])
+                if (x[u] < 0 && used.add(u))
+                    rows[0].push_back(u);
+        }
+        // layer k changes next to them and next to the changes of layer k - 1
+        unsigned int begin = 0;
+        for (int k = 0; k < layers && !full; k++)
+        {
+            if (k > 0)
+                rows[k] = rows[k - 1];
+            std::vector<int> &r = rows[k];
+            unsigned int end = r.size();
+            for (unsigned int i = begin; i < end; i++)
+                for (int u : adj[r[i]])
+                    if (x[u] < 0 && used.add(u))
+                        r.push_back(u);
+            begin = end;
+            full = r.size() * 2 > rn;
+        }
+    }
+    std::vector<int> vs;
+    std::vector<int *> rowPtr(layers);
+    std::vector<int> rowN(layers);
+    if (full)
+        vs = remaining_vertices();
+    for (int k = 0; k < layers; k++)
+    {
+        rowPtr[k] = full ? vs.data() : rows[k].data();
+        rowN[k] = full ? vs.size() : rows[k].size();
+    }
+
+    if (gcnCache.h == NULL)
+        gcnCache = gcn_cache_init(model, n);
+    if (full)
+    {
+        for (int v = 0; v < denseN; v++)
+            gcnCache.scale[v] = x[v] < 0 ? gcn_scale(liveDeg[v]) : 0.0f;
+    }
+    else
+    {
+        for (int v : gcnChanged)
+            if (x[v] >= 0)
+                gcnCache.scale[v] = 0.0f;
+        for (int v : rows[0])
+            gcnCache.scale[v] = gcn_scale(liveDeg[v]);
+    }
+    gcn_eval_rows(model, adj, model_data.pool, gcnCache, rowPtr.data(), rowN.data());
+
+    for (int v : gcnChanged)
+        gcnMark[v] = 0;
+    gcnChanged.clear();
+    if (gcnMark.empty())
+        gcnMark.assign(n, 0);
+
+    int best = -1;
+    for (int v = 0; v < denseN; v++)
+        if (x[v] < 0 && (best < 0 || gcnCache.out[v] > gcnCache.out[best]))
+            best = v;
+    return best;
+}
+
+void branch_and_reduce_algorithm::gcn_check(int v)
+{
+    std::vector<int> vs = remaining_vertices();
+    int layers = gcnRef.hidden_layers + 2;
+    std::vector<int *> rowPtr(layers, vs.data());
+    std::vector<int> rowN(layers, vs.size());
+
+    if (gcnRefCache.h == NULL)
+        gcnRefCache = gcn_cache_init(gcnRef, n);
+    for (int u = 0; u < denseN; u++)
+        gcnRefCache.scale[u] = x[u] < 0 ? gcn_scale(liveDeg[u]) : 0.0f;
+    gcn_eval_rows(gcnRef, adj, model_data.pool, gcnRefCache, rowPtr.data(), rowN.data());
+
+    float best = gcnRefCache.out[v];
+    for (int u : vs)
+        best = std::max(best, gcnRefCache.out[u]);
+
+    stats->precisionPicks++;
+    if (best > gcnRefCache.out[v])
+    {
+        stats->precisionMisses++;
+        double loss = stats->precisionLoss.load();
+        while (!stats->precisionLoss.compare_exchange_weak(loss, loss + (best - gcnRefCache.out[v])))
+            ;
+    }
+}
+
+void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
+{
+    int oldLB = lb;
+    int v = -1, dv = 0;
+    std::vector<int> &mirrors = que;
+    int mirrorN = 0;
+
+    debug_info deb_info;
+    deb_info.type = info_type::Branching;
+    deb_info.depth = depth;
+    deb_info.rn = rn;
+
+    if (config.BRANCHING == 0) // branch on random vertex
+    {
+        int p = rand() % rn;
+        v = remaining_vertices()[p];
+        dv = deg(v);
+    }
+    else if (config.BRANCHING == 1) // branch on vertex with min. deg.
+    {
+        dv = n + 1;
+        for (int u : remaining_vertices())
+            if (x[u] < 0)
+            {
+                int degree = deg(u);
+                if (dv > degree)
+                {
+                    v = u;
+                    dv = degree;
+                }
+            }
+    }
+    else if (config.BRANCHING == 2) // branch on vertex with max. deg. && min. edges among N(v)
+    {
+        v = get_max_deg_vtx();
+        dv = deg(v);
+    }
+    else if (config.BRANCHING == 3) // articulation points
+    {
+        while (!artics.empty() && x[artics.back()] != -1)
+            artics.pop_back();
+
+        if (artics.empty())
+        {
+            get_articulation_points_iteratively();
+            for (int i = 0; i < n; i++)
+                if (articulation_points[i] == 1 && x[i] < 0)
+                    artics.push_back(i);
+
+            if (artics.empty())
+            {
+                artics.push_back(get_max_deg_vtx());
+                stats->defaultPicks++;
+                defaultBranch = true;
+            }
+            else
+            {
+                stats->stratPicks++;
+            }
+        }
+        else
+        {
+            stats->stratPicks++;
+        }
+
+        v = artics.back();
+        artics.pop_back();
+        dv = deg(v);
+    }
+    else if (config.BRANCHING == 4) // edge cuts
+    {
         while (!cut.empty() && x[cut.back()] != -1)
             cut.pop_back();
 
@@ -2487,30 +3000,30 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
                 get_stcut_vertices();
                 if (cut.empty())
                 {
-                    branch_t = depth + TUNING_PARAM3;
+                    branch_t = depth + config.TUNING_PARAM3;
                 }
             }
             if (cut.empty())
             {
                 cut.push_back(get_max_deg_vtx());
-                defaultPicks++;
+                stats->defaultPicks++;
                 defaultBranch = true;
             }
             else
             {
-                stratPicks++;
+                stats->stratPicks++;
             }
         }
         else
         {
-            stratPicks++;
+            stats->stratPicks++;
         }
 
         v = cut.back();
         cut.pop_back();
         dv = deg(v);
     }
-    else if (BRANCHING == 41) // edge cuts - ref 
+    else if (config.BRANCHING == 41) // edge cuts - ref 
     {
         while (!cut.empty() && x[cut.back()] != -1)
             cut.pop_back();
@@ -2522,30 +3035,30 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
                 get_stcut_vertices();
                 if (cut.empty())
                 {
-                    branch_t = depth + TUNING_PARAM3;
+                    branch_t = depth + config.TUNING_PARAM3;
                 }
             }
             if (cut.empty())
             {
                 cut.push_back(get_max_deg_vtx());
-                defaultPicks++;
+                stats->defaultPicks++;
                 defaultBranch = true;
             }
             else
             {
-                stratPicks++;
+                stats->stratPicks++;
             }
         }
         else
         {
-            stratPicks++;
+            stats->stratPicks++;
         }
 
         v = cut.back();
         cut.pop_back();
         dv = deg(v);
     }
-    else if (BRANCHING == 5) // nested dissection
+    else if (config.BRANCHING == 5) // nested dissection
     {
 #ifdef USE_IFC
         if (nd_computed == false)
@@ -2557,7 +3070,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (nd_order.empty())
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
             defaultBranch = true;
         }
         else
@@ -2568,14 +3081,14 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
                 if (x[nd_order[i]] < 0)
                 {
                     v = nd_order[i];
-                    stratPicks++;
+                    stats->stratPicks++;
                     break;
                 }
             }
             if (v == -1)
             {
                 v = get_max_deg_vtx();
-                defaultPicks++;
+                stats->defaultPicks++;
                 defaultBranch = true;
             }
         }
@@ -2587,7 +3100,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
 #endif
     }
 
-    else if (BRANCHING == 6) // twin-reduction-based
+    else if (config.BRANCHING == 6) // twin-reduction-based
     {
         int vv = -1;
         int dvv = -1;
@@ -2604,16 +3117,16 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (vv == -1)
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
         }
         else
         {
             int vvv = get_max_deg_vtx();
-            int min_deg = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)(((double)TUNING_PARAM1 / 100.0) * deg(vvv));
+            int min_deg = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)(((double)config.TUNING_PARAM1 / 100.0) * deg(vvv));
             if (deg(vv) >= deg(vvv) - min_deg)
             {
                 v = vv;
-                stratPicks++;
+                stats->stratPicks++;
             }
             else
                 v = vvv;
@@ -2622,7 +3135,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         b_vtcs.clear();
         dv = deg(v);
     }
-    else if (BRANCHING == 7) // funnel-reduction-based
+    else if (config.BRANCHING == 7) // funnel-reduction-based
     {
         int vv = -1;
         int dvv = -1;
@@ -2639,16 +3152,16 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (vv == -1)
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
         }
         else
         {
             int vvv = get_max_deg_vtx();
-            int min_deg = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)(((double)TUNING_PARAM1 / 100.0) * deg(vvv));
+            int min_deg = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)(((double)config.TUNING_PARAM1 / 100.0) * deg(vvv));
             if (deg(vv) >= deg(vvv) - min_deg)
             {
                 v = vv;
-                stratPicks++;
+                stats->stratPicks++;
             }
             else
                 v = vvv;
@@ -2657,7 +3170,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         b_vtcs.clear();
         dv = deg(v);
     }
-    else if (BRANCHING == 8) // unconfined-reduction-based
+    else if (config.BRANCHING == 8) // unconfined-reduction-based
     {
         int vv = -1;
         int dvv = -1;
@@ -2674,16 +3187,16 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (vv == -1)
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
         }
         else
         {
             int vvv = get_max_deg_vtx();
-            int min_deg = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)(((double)TUNING_PARAM1 / 100.0) * deg(vvv));
+            int min_deg = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)(((double)config.TUNING_PARAM1 / 100.0) * deg(vvv));
             if (deg(vv) >= deg(vvv) - min_deg)
             {
                 v = vv;
-                stratPicks++;
+                stats->stratPicks++;
             }
             else
                 v = vvv;
@@ -2692,7 +3205,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         b_vtcs.clear();
         dv = deg(v);
     }
-    else if (BRANCHING == 9) // combined
+    else if (config.BRANCHING == 9) // combined
     {
         int vv = -1;
         int dvv = -1;
@@ -2709,16 +3222,16 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (vv == -1)
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
         }
         else
         {
             int vvv = get_max_deg_vtx();
-            int min_deg = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)(((double)TUNING_PARAM1 / 100.0) * deg(vvv));
+            int min_deg = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)(((double)config.TUNING_PARAM1 / 100.0) * deg(vvv));
             if (deg(vv) >= deg(vvv) - min_deg)
             {
                 v = vv;
-                stratPicks++;
+                stats->stratPicks++;
             }
             else
                 v = vvv;
@@ -2727,7 +3240,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         b_vtcs.clear();
         dv = deg(v);
     }
-    else if (BRANCHING == 10) // packing-reduction-based
+    else if (config.BRANCHING == 10) // packing-reduction-based
     {
         int vv = -1;
         int dvv = -1;
@@ -2744,16 +3257,16 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (vv == -1)
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
         }
         else
         {
             int vvv = get_max_deg_vtx();
-            int min_deg = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)(((double)TUNING_PARAM1 / 100.0) * deg(vvv));
+            int min_deg = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)(((double)config.TUNING_PARAM1 / 100.0) * deg(vvv));
             if (deg(vv) >= deg(vvv) - min_deg)
             {
                 v = vv;
-                stratPicks++;
+                stats->stratPicks++;
             }
             else
                 v = vvv;
@@ -2762,7 +3275,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         b_vtcs.clear();
         dv = deg(v);
     }
-    else if (BRANCHING == 11) // combined + packing
+    else if (config.BRANCHING == 11) // combined + packing
     {
         int vv = -1;
         int dvv = -1;
@@ -2779,16 +3292,16 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (vv == -1)
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
         }
         else
         {
             int vvv = get_max_deg_vtx();
-            int min_deg = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)(((double)TUNING_PARAM1 / 100.0) * deg(vvv));
+            int min_deg = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)(((double)config.TUNING_PARAM1 / 100.0) * deg(vvv));
             if (deg(vv) >= deg(vvv) - min_deg)
             {
                 v = vv;
-                stratPicks++;
+                stats->stratPicks++;
             }
             else
                 v = vvv;
@@ -2797,7 +3310,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         b_vtcs.clear();
         dv = deg(v);
     }
-    else if (BRANCHING == 12) // Nested Dissection - METIS
+    else if (config.BRANCHING == 12) // Nested Dissection - METIS
     {
         if (nd_computed == false)
         {
@@ -2808,7 +3321,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (nd_order.empty())
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
             defaultBranch = true;
         }
         else
@@ -2819,21 +3332,21 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
                 if (x[nd_order[i]] < 0)
                 {
                     v = nd_order[i];
-                    stratPicks++;
+                    stats->stratPicks++;
                     break;
                 }
             }
             if (v == -1)
             {
                 v = get_max_deg_vtx();
-                defaultPicks++;
+                stats->defaultPicks++;
                 defaultBranch = true;
             }
         }
 
         dv = deg(v);
     }
-    else if (BRANCHING == 13) // Nested Dissection - METIS
+    else if (config.BRANCHING == 13) // Nested Dissection - METIS
     {
         if (nd_computed == false)
         {
@@ -2844,7 +3357,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         if (nd_order.empty())
         {
             v = get_max_deg_vtx();
-            defaultPicks++;
+            stats->defaultPicks++;
             defaultBranch = true;
         }
         else
@@ -2855,72 +3368,28 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
                 if (x[nd_order[i]] < 0)
                 {
                     v = nd_order[i];
-                    stratPicks++;
+                    stats->stratPicks++;
                     break;
                 }
             }
             if (v == -1)
             {
                 v = get_max_deg_vtx();
-                defaultPicks++;
+                stats->defaultPicks++;
                 defaultBranch = true;
             }
         }
 
         dv = deg(v);
     }
-    else if (BRANCHING == 14) // Machine learning
+    else if (config.BRANCHING == 14) // Machine learning
     {
-        static std::vector<int> new_id(N, 0), old_id(N, 0);
-        if (new_id.size() < n)
-        {
-            new_id.resize(n);
-            old_id.resize(n);
-        }
-        
-        int next_label = 0;
-        
-        for (int i = 0; i < n; i++)
-        {
-            if (x[i] < 0)
-            {
-                new_id[i] = next_label;
-                old_id[next_label] = i;
-                next_label++;
-            }
-        }
-        
-        model_data.N = next_label;
-        model_data.V[0] = 0;
-        
-        for (int i = 0; i < model_data.N; i++)
-        {
-            model_data.V[i + 1] = model_data.V[i];
-            for (int j : adj[old_id[i]])
-            {
-                if (x[j] < 0)
-                {
-                    model_data.E[model_data.V[i + 1]] = new_id[j];
-                    model_data.V[i + 1]++;
-                }
-            }
-        }
-        
-        gcn_eval(model, model_data);
-        
-        int best = 0;
-        for (int i = 1; i < model_data.N; i++)
-        {
-            if (model_data.y[i] > model_data.y[best])
-            {
-                best = i;
-            }
-        }
-        
-        v = old_id[best];
+        v = gcn_pick();
+        if (gcnRef.params != NULL)
+            gcn_check(v);
         dv = deg(v);
     }
-    else if (BRANCHING == 20) // st - cut refinement
+    else if (config.BRANCHING == 20) // st - cut refinement
     {
         int cut_size = 0;
         for (int v : cut)
@@ -2936,18 +3405,18 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
                 cut_size = cut.size();
                 if (cut.empty())
                 {
-                    branch_t = depth + TUNING_PARAM3;
+                    branch_t = depth + config.TUNING_PARAM3;
                     cut_size = -1;
                 }
             }
             else cut_size = -1;
               
         } 
-        unsigned int max_size = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)((((double)(-TUNING_PARAM1)) / 100) * (double)rn);
+        unsigned int max_size = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)((((double)(-config.TUNING_PARAM1)) / 100) * (double)rn);
         if (cut_size > max_size && cut_size > 0)
         {
             if (perform_refinement) {
-                int max_partition_size = TUNING_PARAM2 * (rn - cut_size);
+                int max_partition_size = config.TUNING_PARAM2 * (rn - cut_size);
                 int ref = ls_refinement.perform_refinement(adj, cut, max_partition_size);
                 if (ref > 0) {
                     std::vector<int> n_separator;
@@ -2959,7 +3428,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
                 }
                 perform_refinement = false;
             }
-            defaultPicks++;
+            stats->defaultPicks++;
             defaultBranch = true;
             
             // deb info
@@ -2973,7 +3442,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
             // deb info
             deb_info.add_stats.emplace_back("strat_pick: ", 1);
 
-            stratPicks++;
+            stats->stratPicks++;
             int ddv = 0;
             for (int u : cut) {
                 if (x[u] < 0 && deg(u) > ddv) {
@@ -2988,7 +3457,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         
         dv = deg(v);
     }
-    else if (BRANCHING == 21) 
+    else if (config.BRANCHING == 21) 
     {
         int separator_size = 0;
         for (int v : separator)
@@ -3002,11 +3471,11 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
             compute_metis_sep();
             separator_size = separator.size();   
         } 
-        unsigned int max_size = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)((((double)(-TUNING_PARAM1)) / 100) * (double)rn);
+        unsigned int max_size = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)((((double)(-config.TUNING_PARAM1)) / 100) * (double)rn);
         if (separator_size > max_size)
         {
             if (perform_refinement) {
-                int max_partition_size = TUNING_PARAM2 * (rn - separator_size);
+                int max_partition_size = config.TUNING_PARAM2 * (rn - separator_size);
                 int ref = ls_refinement.perform_refinement(adj, separator, max_partition_size);
                 if (ref > 0) {
                     std::vector<int> n_separator;
@@ -3018,7 +3487,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
                 }
                 perform_refinement = false;
             }
-            defaultPicks++;
+            stats->defaultPicks++;
             defaultBranch = true;
             
             // deb info
@@ -3032,7 +3501,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
             // deb info
             deb_info.add_stats.emplace_back("strat_pick: ", 1);
 
-            stratPicks++;
+            stats->stratPicks++;
             int ddv = 0;
             for (int u : separator) {
                 if (x[u] < 0 && deg(u) > ddv) {
@@ -3047,7 +3516,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         
         dv = deg(v);
     } 
-    else if (BRANCHING == 31) // new combined
+    else if (config.BRANCHING == 31) // new combined
     {
         int pv = -1;
         int dpv = -1;
@@ -3097,7 +3566,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         v = get_max_deg_vtx();
         dv = deg(v);
 
-        if (TUNING_PARAM1 == 0) 
+        if (config.TUNING_PARAM1 == 0) 
         {
             if (dpv != -1 && dpv >= dv - packing_thresh)
             {
@@ -3125,7 +3594,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
             }
             else deb_info.add_stats.emplace_back("strat_pick: ", 0);
         }
-        else if (TUNING_PARAM1 == 1) 
+        else if (config.TUNING_PARAM1 == 1) 
         {
             int mdv = -1;
             if (dpv != -1 && dpv >= dv - packing_thresh && dpv > mdv) 
@@ -3221,7 +3690,42 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
         }
     int pn = rn;
     unsigned int oldP = packing.size(); // update packing constr.
-    if (REDUCTION >= 3)
+
+    // while threads are idle, the 0-branch is searched by a fork and this thread goes on with the 1-branch,
+    // close to the root this is done even if all threads are busy, the fork then waits in the queue
+    bool speculate = depth - rootDepth < config.SPECULATE_DEPTH;
+    thread_pool *pool = speculate || (config.SPLIT_N > 0 && rn >= config.SPLIT_N) ? shared_pool(config) : nullptr;
+    branch_and_reduce_algorithm *sub = nullptr;
+    std::atomic<bool> subDone(false);
+    bool remoteSub = false;
+    int remoteTask = -1;
+    if (pool != nullptr && (speculate || pool->wants_work()))
+    {
+        exclude(v, mirrorN > 0);
+        sub = fork();
+        sub->depth = depth + 1;
+        restore(pn);
+        while (packing.size() > oldP)
+            popPacking();
+        pool->submit([sub, &t, time_limit, &subDone]() {
+            with_own_gcn_data(sub, [sub, &t, time_limit]() { sub->rec(t, time_limit); });
+            subDone = true;
+        });
+    }
+    else if (remote != nullptr && config.SPLIT_N > 0 && rn >= config.SPLIT_N && remote->idle())
+    {
+        // the same for idle worker processes
+        exclude(v, mirrorN > 0);
+        sub = fork();
+        sub->depth = depth + 1;
+        restore(pn);
+        while (packing.size() > oldP)
+            popPacking();
+        remoteSub = true;
+        remoteTask = sub->submit_remote(t, time_limit);
+    }
+
+    if (config.REDUCTION >= 3)
     {
         std::vector<int> &tmp = level;
         int p = 0;
@@ -3235,7 +3739,7 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
     set(v, 1);
     for (int i = 0; i < mirrorN; i++)
         set(mirrors[i], 1);
-    if (debug >= 2 && depth <= maxDepth)
+    if (config.debug >= 2 && depth <= maxDepth)
     {
         if (mirrorN > 0)
             fprintf(stderr, "%sbranchMirror (%d, %d): 1\n", debugString().c_str(), dv, mirrorN);
@@ -3255,9 +3759,27 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
     // optimal branch order
     crntBest = opt;
 
-    nBranchings++;
+    stats->nBranchings++;
 
-    if (lb >= opt)
+    if (sub != nullptr)
+    {
+        if (!remoteSub)
+            pool->help_while([&subDone]() { return !subDone; });
+        else if (!sub->finish_remote(remoteTask)) // all workers were busy after all or the worker died
+            sub->rec(t, time_limit);
+        if (sub->opt < opt)
+        {
+            opt = sub->opt;
+            y.swap(sub->y);
+            startingSolutionIsBest = false;
+        }
+        if (max_depth < sub->max_depth)
+            max_depth = sub->max_depth;
+        delete sub;
+        return;
+    }
+
+    if (lb >= cutoff())
     {
         if (startingSolutionIsBest)
         {
@@ -3270,61 +3792,12 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
 
     if (defaultBranch)
     {
-        defaultBranchings++;
+        stats->defaultBranchings++;
         defaultBranch = false;
     }
 
-    if (mirrorN == 0)
-    {
-        used.clear();
-        used.add(v);
-        for (int u : adj[v])
-            if (x[u] < 0)
-                used.add(u);
-        if (REDUCTION >= 3)
-        {
-            std::vector<int> ws(n, -1);
-            for (int u : adj[v])
-                if (x[u] < 0)
-                {
-                    std::vector<int> &tmp = level;
-                    int p = 0;
-                    tmp[p++] = 1;
-                    for (int w : adj[u])
-                        if (x[w] < 0 && !used.get(w))
-                        {
-                            tmp[p++] = w;
-                            ws[w] = u;
-                        }
-                    assert(p >= 2);
-                    for (int u2 : adj[tmp[1]])
-                        if (x[u2] < 0 && used.get(u2) && u2 != u)
-                        {
-                            int c = 0;
-                            for (int w : adj[u2])
-                                if (x[w] < 0)
-                                {
-                                    if (ws[w] == u)
-                                        c++;
-                                    else if (w == u || !used.get(w))
-                                    {
-                                        c = -1;
-                                        break;
-                                    }
-                                }
-                            if (c == p - 1)
-                            {
-                                tmp[0] = 2;
-                                break;
-                            }
-                        }
-                    std::vector<int> copyOfTmp(tmp.begin(), tmp.begin() + p);
-                    pushPacking(copyOfTmp);
-                }
-        }
-    }
-    set(v, 0);
-    if (debug >= 2 && depth <= maxDepth)
+    exclude(v, mirrorN > 0);
+    if (config.debug >= 2 && depth <= maxDepth)
         fprintf(stderr, "%sbranch (%d): 0\n", debugString().c_str(), dv);
     depth++;
     if (depth > max_depth)
@@ -3337,6 +3810,101 @@ void branch_and_reduce_algorithm::branching(timer &t, double time_limit)
     restore(pn);
 }
 
+// solves a component on a pool thread
+static void solve_component(branch_and_reduce_algorithm *vc, timer &t, double time_limit)
+{
+    with_own_gcn_data(vc, [vc, &t, time_limit]() { vc->solve(t, time_limit); });
+}
+
+// runs f(begin, end) for about four ranges of [0, n) per thread and waits for all of them
+template <typename F>
+static void for_blocks(thread_pool *pool, int n, F f)
+{
+    int tasks = pool->size() * 4;
+    int block = (n + tasks - 1) / tasks;
+    std::atomic<int> pending(0);
+    for (int b = block; b < n; b += block)
+    {
+        pending++;
+        pool->submit([&f, &pending, b, block, n]() {
+            f(b, std::min(n, b + block));
+            pending--;
+        });
+    }
+    f(0, std::min(n, block));
+    pool->help_while([&pending]() { return pending > 0; });
+}
+
+// components of the remaining graph with a concurrent union-find on id, a root is only ever hooked below a
+// smaller root, so id[v] ends up as the smallest vertex of the component, as in the sequential search.
+// size[r] is set for the roots, consecutive vertices mostly share a root and are counted together
+int branch_and_reduce_algorithm::parallel_components(thread_pool *pool, std::vector<int> const &remaining, std::vector<int> &id, std::vector<int> &size)
+{
+    int *parent = id.data();
+    auto find = [parent](int v) {
+        for (;;)
+        {
+            int p = __atomic_load_n(&parent[v], __ATOMIC_RELAXED);
+            if (p == v)
+                return v;
+            int g = __atomic_load_n(&parent[p], __ATOMIC_RELAXED);
+            if (g != p) // path halving, any ancestor of v is a valid parent
+                __atomic_store_n(&parent[v], g, __ATOMIC_RELAXED);
+            v = g;
+        }
+    };
+
+    int r = remaining.size();
+    for_blocks(pool, r, [&](int b, int e) {
+        for (int i = b; i < e; i++)
+        {
+            parent[remaining[i]] = remaining[i];
+            size[remaining[i]] = 0;
+        }
+    });
+    for_blocks(pool, r, [&](int b, int e) {
+        for (int i = b; i < e; i++)
+        {
+            int v = remaining[i];
+            for (int u : adj[v])
+                if (x[u] < 0 && u < v)
+                    for (;;)
+                    {
+                        int a = find(u), c = find(v);
+                        if (a == c)
+                            break;
+                        if (a > c)
+                            std::swap(a, c);
+                        if (__atomic_compare_exchange_n(&parent[c], &c, a, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                            break;
+                    }
+        }
+    });
+    std::vector<int> &root = que;
+    for_blocks(pool, r, [&](int b, int e) {
+        for (int i = b; i < e; i++)
+            root[i] = find(remaining[i]);
+    });
+    std::atomic<int> nC(0);
+    for_blocks(pool, r, [&](int b, int e) {
+        for (int i = b; i < e; i++)
+            parent[remaining[i]] = root[i];
+        int roots = 0;
+        for (int i = b; i < e;)
+        {
+            int c = parent[remaining[i]], k = 0;
+            for (; i < e && parent[remaining[i]] == c; i++)
+                k++;
+            __atomic_fetch_add(&size[c], k, __ATOMIC_RELAXED);
+        }
+        for (int i = b; i < e; i++)
+            if (parent[remaining[i]] == remaining[i])
+                roots++;
+        nC += roots;
+    });
+    return nC;
+}
+
 bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
 {
     // FIND CC'S
@@ -3345,10 +3913,17 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
         std::vector<int> &id = level;  // representative of the component
         std::vector<int> &size = iter; // size of the components
         int nC = 0;
+        std::vector<int> remaining = remaining_vertices();
+        thread_pool *pool = rn >= config.PARALLEL_CC_N ? shared_pool(config) : nullptr;
+        if (pool != nullptr)
         {
-            for (int i = 0; i < n; i++)
+            nC = parallel_components(pool, remaining, id, size);
+        }
+        else
+        {
+            for (int i : remaining)
                 id[i] = -1;
-            for (int s = 0; s < n; s++)
+            for (int s : remaining)
                 if (x[s] < 0 && id[s] < 0) // new components
                 {
                     nC++;
@@ -3376,8 +3951,8 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
         std::vector<long long> cs(nC, 0);
         {
             int p = 0;
-            for (int i = 0; i < n; i++)
-                if (x[i] < 0 && id[i] == i)
+            for (int i : remaining)
+                if (id[i] == i)
                 {
                     cs[p++] = ((long long)(size[i])) << 32 | i;
                 }
@@ -3403,22 +3978,38 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
 
 
         vss.resize(nC);
-        std::vector<int> qs(n, 0);
         {
+            std::vector<int> &qs = size; // component sizes are not needed after this
             for (int i = 0; i < nC; i++)
             {
                 vss[i].resize(size[(int)cs[i]]);
                 qs[(int)cs[i]] = i;
             }
             std::vector<int> ps(nC);
-            for (int i = 0; i < n; i++)
-                if (x[i] < 0)
+            if (pool != nullptr)
+            {
+                // the order inside a component does not matter, it is sorted below
+                for_blocks(pool, remaining.size(), [&](int b, int e) {
+                    for (int i = b; i < e;)
+                    {
+                        int j = qs[id[remaining[i]]], k = i;
+                        for (; i < e && qs[id[remaining[i]]] == j; i++)
+                            ;
+                        int p = __atomic_fetch_add(&ps[j], i - k, __ATOMIC_RELAXED);
+                        std::copy(remaining.begin() + k, remaining.begin() + i, vss[j].begin() + p);
+                    }
+                });
+            }
+            else
+            {
+                for (int i : remaining)
                 {
                     int j = qs[id[i]];
                     vss[j][ps[j]++] = i;
                 }
+            }
         }
-        for (int i = 0; i < n; i++)
+        for (int i : remaining)
             id[i] = -1;
         for (unsigned int i = 0; i < vss.size(); i++)
         {
@@ -3435,7 +4026,7 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
 
     std::vector<int> x2(x);
     for (int i = modifiedN - 1; i >= 0; i--)
-        modifieds[i]->reverse(x2);
+        reverse_modified(modifieds[i], x2);
     std::vector<int> size(vss.size());
     for (unsigned int i = 0; i < vss.size(); i++)
         size[i] = vss[i].size();
@@ -3485,20 +4076,20 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
         for (int i = 0; i < modifiedN; i++)
         {
             bool b = false;
-            shared_ptr<modified> mod = modifieds[i];
-            for (int v : mod->removed)
+            modified const &mod = modifieds[i];
+            for (int v : mod_removed(mod))
                 if (need[v])
                     b = true;
             if (b)
             {
-                if (dynamic_cast<fold *>(mod.get()) != nullptr)
+                if (mod.kind == modified::FOLD)
                 {
-                    if (x2[mod->vs[0]] == 2)
-                        need[mod->vs[0]] = true;
+                    if (x2[mod_vs(mod)[0]] == 2)
+                        need[mod_vs(mod)[0]] = true;
                 }
                 else
                 {
-                    for (int v : mod->vs)
+                    for (int v : mod_vs(mod))
                         if (x2[v] == 2)
                         {
                             need[v] = true;
@@ -3508,19 +4099,19 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
         }
         for (int i = modifiedN - 1; i >= 0; i--)
         {
-            shared_ptr<modified> mod = modifieds[i];
+            modified const &mod = modifieds[i];
             bool b = false;
-            for (int v : mod->removed)
+            for (int v : mod_removed(mod))
                 if (need[v])
                     b = true;
             if (b)
             {
-                if (dynamic_cast<fold *>(mod.get()) != nullptr)
+                if (mod.kind == modified::FOLD)
                 {
-                    for (int v : mod->removed)
+                    for (int v : mod_removed(mod))
                     {
                         assert(pos1[v] == -1);
-                        pos1[v] = pos1[mod->vs[0]];
+                        pos1[v] = pos1[mod_vs(mod)[0]];
                         assert(pos1[v] >= 0);
                         pos2[v] = size[pos1[v]]++;
                     }
@@ -3528,11 +4119,11 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
                 else
                 {
                     int max = -1;
-                    for (int v : mod->vs)
+                    for (int v : mod_vs(mod))
                         if (max < pos1[v])
                             max = pos1[v];
                     assert(max >= 0);
-                    for (int v : mod->removed)
+                    for (int v : mod_removed(mod))
                     {
                         assert(pos1[v] == -1);
                         pos1[v] = max;
@@ -3557,21 +4148,28 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
         {
             std::vector<int> &vs = vss[i];
             size[i] += 2;
-            std::vector<std::vector<int>> adj2(vs.size()); // create new adj. list
+            std::vector<long long> offsets(vs.size() + 1, 0); // create new adj. array
+            for (int j = 0; j < static_cast<int>(vs.size()); j++)
+                offsets[j + 1] = offsets[j] + deg(vs[j]);
+            std::vector<int> nbr(offsets[vs.size()]);
             for (int j = 0; j < static_cast<int>(vs.size()); j++)
             {
-                adj2[j].resize(deg(vs[j]), 0);
-                int p = 0;
+                long long p = offsets[j];
                 for (int u : adj[vs[j]])
                     if (x[u] < 0)
-                        adj2[j][p++] = pos2[u];
-                assert(p == adj2[j].size());
-                std::sort(adj2[j].begin(), adj2[j].end());
+                        nbr[p++] = pos2[u];
+                assert(p == offsets[j + 1]);
+                std::sort(nbr.begin() + offsets[j], nbr.begin() + p);
             }
+            dyn_csr adj2(offsets, nbr);
 
-            vcs[i] = new branch_and_reduce_algorithm(adj2, size[i]);
+            vcs[i] = new branch_and_reduce_algorithm(adj2, size[i], config);
+            vcs[i]->stats = stats;
+            vcs[i]->cancel = cancel;
+            vcs[i]->remote = remote;
             vcs[i]->model = model;
             vcs[i]->model_data = model_data;
+            vcs[i]->gcnRef = gcnRef;
 
             // inherit nd branching order ypp
             std::vector<int> sub_nd_order(0);
@@ -3640,11 +4238,34 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
     {
         for (int i = 0; i < modifiedN; i++)
         {
-            shared_ptr<modified> mod = modifieds[i];
-            int p = pos1[mod->removed[0]];
+            modified const &mod = modifieds[i];
+            int p = pos1[mod_removed(mod)[0]];
             if (p >= 0)
             {
-                vcs[p]->modifieds[vcs[p]->modifiedN++] = mod;
+                // the component gets a remapped copy that is only used by reverse()
+                branch_and_reduce_algorithm *vc = vcs[p];
+                int removedBegin = vc->modVertices.size();
+                for (int v : mod_removed(mod))
+                {
+                    assert(pos1[v] == p);
+                    vc->modVertices.push_back(pos2[v]);
+                }
+                int vsBegin = vc->modVertices.size();
+                for (int v : mod_vs(mod))
+                {
+                    if (pos1[v] == p)
+                    {
+                        vc->modVertices.push_back(pos2[v]);
+                    }
+                    else
+                    {
+                        assert(x2[v] == 0 || x2[v] == 1);
+                        vc->modVertices.push_back(vc->N - 2 + x2[v]);
+                    }
+                    if (mod.kind == modified::FOLD)
+                        break;
+                }
+                vc->push_modified(mod.kind, 0, mod.k, removedBegin, vsBegin, -1, dyn_csr::position());
             }
         }
     }
@@ -3659,9 +4280,13 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
                 vss2[pos1[i]][pos2[i]] = i;
     }
     int sum = crt;
+    int best = cutoff(); // the components together have to beat this
     // std::vector<bool> optChanged(vss.size(), false);
 
-    for (int i = 0; i < static_cast<int>(vss.size()) && opt > sum; i++)
+    // several components are handed to the thread pool, they are solved below
+    thread_pool *pool = vss.size() > 1 ? shared_pool(config) : nullptr;
+
+    for (int i = 0; i < static_cast<int>(vss.size()) && best > sum; i++)
     {
         branch_and_reduce_algorithm *vc = vcs[i];
 
@@ -3693,7 +4318,7 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
                 std::vector<int> copyOfTmp(tmp.begin(), tmp.begin() + p);
                 packing2.emplace_back(std::move(copyOfTmp));
 
-                if (USE_DEPENDENCY_CHECKING) {
+                if (config.USE_DEPENDENCY_CHECKING) {
                     int nPack = packing2.size() - 1;
                     std::vector<int> &pck = packing2.back();
                     for (int i = 1; i < pck.size(); i++) {
@@ -3706,55 +4331,8 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
             (vc->packing).swap(packing2);
         }
 
-        {
-            for (int j = 0; j < vc->modifiedN; j++)
-            {
-                shared_ptr<modified> mod = vc->modifieds[j];
-                std::vector<int> removed(mod->removed.size());
-                for (unsigned int k = 0; k < removed.size(); k++)
-                {
-                    int v = mod->removed[k];
-                    assert(pos1[v] == i);
-                    removed[k] = pos2[v];
-                }
-                if (dynamic_cast<fold *>(mod.get()) != nullptr)
-                {
-                    std::vector<int> vs(1, 0);
-                    int v = mod->vs[0];
-                    if (pos1[v] == i)
-                    {
-                        vs[0] = pos2[v];
-                    }
-                    else
-                    {
-                        assert(x2[v] == 0 || x2[v] == 1);
-                        vs[0] = vc->N - 2 + x2[v];
-                    }
-                    mod = make_shared<fold>(fold(removed, vs, this));
-                }
-                else
-                {
-                    std::vector<int> vs(mod->vs.size(), 0);
-                    for (unsigned int k = 0; k < vs.size(); k++)
-                    {
-                        int v = mod->vs[k];
-                        if (pos1[v] == i)
-                        {
-                            vs[k] = pos2[v];
-                        }
-                        else
-                        {
-                            assert(x2[v] == 0 || x2[v] == 1);
-                            vs[k] = vc->N - 2 + x2[v];
-                        }
-                    }
-                    mod = make_shared<alternative>(alternative(removed, vs, this, dynamic_cast<alternative *>(mod.get())->k));
-                }
-                vc->modifieds[j] = mod;
-            }
-        }
         vc->depth = depth + (vss.size() > 1 ? 1 : 0);
-        if (debug >= 2 && depth <= maxDepth)
+        if (config.debug >= 2 && depth <= maxDepth)
         {
             if (vss.size() == 1)
                 fprintf(stderr, "%sshrink: %d -> %d (%d)\n", debugString().c_str(), n, vcs[i]->n, vcs[i]->N);
@@ -3763,12 +4341,17 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
         }
         if (i + 1 == static_cast<int>(vss.size()))
         {
-            vc->opt = std::min(vss[i].size(), static_cast<size_t>(opt - sum));
+            vc->opt = std::min(vss[i].size(), static_cast<size_t>(best - sum));
         }
 
         vc->reverse();
         for (int j = 0; j < vc->N; j++)
             assert(vc->y[j] == 0 || vc->y[j] == 1);
+        // bounds found by other threads while the component is searched prune it as well
+        vc->outer = this;
+        if (pool != nullptr)
+            continue;
+        vc->outerBase = sum;
 
         // Map current optimal solution to CC
         // int optForMapping = 0;
@@ -3813,17 +4396,53 @@ bool branch_and_reduce_algorithm::decompose(timer &t, double time_limit)
         }
     }
 
-    for (int i = 0; i < vcs.size(); i++)
+    if (pool != nullptr)
     {
-        branch_and_reduce_algorithm *pAlg = vcs[i];
-        std::vector<int> &vs = vss[i];
+        // every component only has to beat best minus the lower bounds of the others
+        std::vector<int> lbs(vss.size());
+        int lbSum = crt;
+        for (unsigned int i = 0; i < vss.size(); i++)
+        {
+            lbs[i] = vcs[i]->lowerBound();
+            lbSum += lbs[i];
+        }
+        if (lbSum >= best) // pruned by the lower bounds
+        {
+            sum = lbSum;
+        }
+        else
+        {
+            std::atomic<int> pending(vss.size());
+            for (int i = static_cast<int>(vss.size()) - 1; i >= 0; i--) // largest first
+            {
+                branch_and_reduce_algorithm *vc = vcs[i];
+                vc->opt = std::min(vc->opt, best - (lbSum - lbs[i]));
+                vc->outerBase = lbSum - lbs[i];
+                pool->submit([vc, &t, time_limit, &pending]() {
+                    solve_component(vc, t, time_limit);
+                    pending--;
+                });
+            }
+            pool->help_while([&pending]() { return pending > 0; });
+
+            for (unsigned int i = 0; i < vss.size(); i++)
+            {
+                branch_and_reduce_algorithm *vc = vcs[i];
+                sum += vc->opt;
+                if (this->max_depth < vc->max_depth)
+                    this->max_depth = vc->max_depth;
+                for (int j = 0; j < vc->N - 2; j++)
+                    x2[vss2[i][j]] = vc->y[j];
+            }
+        }
     }
 
-    if (opt > sum) // new best solution found -> set solution
+    if (best > sum) // new best solution found -> set solution
     {
-        if (debug >= 2 && rootDepth <= maxDepth)
+        if (config.debug >= 2 && rootDepth <= maxDepth)
             fprintf(stderr, "%sopt: %d -> %d\n", debugString().c_str(), opt, sum);
         opt = sum;
+        share_opt();
         y = x;
         startingSolutionIsBest = false;
         for (unsigned int i = 0; i < vss.size(); i++)
@@ -3892,17 +4511,17 @@ bool branch_and_reduce_algorithm::reduce()
     int oldn = rn;
     for (;;)
     {
-        if (REDUCTION >= 0)
+        if (config.REDUCTION >= 0)
             deg1Reduction();
-        // if (n > 100 && n * SHRINK >= rn &&!outputLP && decompose()) return true;
-        if (REDUCTION >= 0 && REDUCTION < 2 && dominateReduction())
+        // if (n > 100 && n * SHRINK >= rn &&!config.outputLP && decompose()) return true;
+        if (config.REDUCTION >= 0 && config.REDUCTION < 2 && dominateReduction())
             continue;
 
-        if (REDUCTION >= 2 && unconfinedReduction())
+        if (config.REDUCTION >= 2 && unconfinedReduction())
             continue;
-        if (REDUCTION >= 1 && lpReduction())
+        if (config.REDUCTION >= 1 && lpReduction())
             continue;
-        if (REDUCTION >= 3)
+        if (config.REDUCTION >= 3)
         {
             int r = packingReduction();
             if (r < 0)
@@ -3910,35 +4529,67 @@ bool branch_and_reduce_algorithm::reduce()
             if (r > 0)
                 continue;
         }
-        if (REDUCTION >= 1 && fold2Reduction())
+        if (config.REDUCTION >= 1 && fold2Reduction())
             continue;
-        if (REDUCTION >= 2 && twinReduction())
+        if (config.REDUCTION >= 2 && twinReduction())
             continue;
-        if (REDUCTION >= 2 && funnelReduction())
+        if (config.REDUCTION >= 2 && funnelReduction())
             continue;
-        if (REDUCTION >= 2 && deskReduction())
+        if (config.REDUCTION >= 2 && deskReduction())
             continue;
         break;
     }
-    if (debug >= 2 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 2 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sreduce: %d -> %d\n", debugString().c_str(), oldn, rn);
     return false;
 }
 
+template <int W>
+void branch_and_reduce_algorithm::solve_small(small_kernel<W> &sk, timer &t, double time_limit)
+{
+    std::vector<int> vs = remaining_vertices();
+    std::vector<int> &id = iter;
+    for (int i = 0; i < rn; i++)
+        id[vs[i]] = i;
+    sk.init(rn);
+    for (int i = 0; i < rn; i++)
+        for (int u : adj[vs[i]])
+            if (x[u] < 0 && id[u] > i)
+                sk.add_edge(i, id[u]);
+
+    // a smaller cover than opt leaves more than rn - (opt - crt) vertices
+    std::vector<int> is;
+    int size = sk.solve(rn - (cutoff() - crt), is, [&]() { return stopped(t, time_limit); });
+    stats->smallBranchings += sk.branchings();
+    if (size < 0)
+        return;
+    if (config.debug >= 2 && rootDepth <= maxDepth)
+        fprintf(stderr, "%sopt: %d -> %d\n", debugString().c_str(), opt, crt + rn - static_cast<int>(is.size()));
+    opt = crt + rn - is.size();
+    share_opt();
+    y = x;
+    for (int v : vs)
+        y[v] = 1;
+    for (int i : is)
+        y[vs[i]] = 0;
+    startingSolutionIsBest = false;
+    reverse();
+}
+
 void branch_and_reduce_algorithm::rec(timer &t, double time_limit)
 {
-    if (t.elapsed() >= time_limit)
+    if (stopped(t, time_limit))
         return;
-    if (REDUCTION < 3)
+    if (config.REDUCTION < 3)
         assert(packing.size() == 0);
 
-    // if (EXTRA_DECOMP == 1)
+    // if (config.EXTRA_DECOMP == 1)
     // {
     //     if (decompose(t, time_limit)) // check for CC's
     //         return;
     // }
 
-    if (USE_DEPENDENCY_CHECKING) {
+    if (config.USE_DEPENDENCY_CHECKING) {
         if (reduce_dc()) // kernelization
             return;
     }
@@ -3948,9 +4599,9 @@ void branch_and_reduce_algorithm::rec(timer &t, double time_limit)
     }
 
 
-    if (lowerBound() >= opt) // pruned by LowerBound
+    if (lowerBound() >= cutoff()) // pruned by LowerBound
     {
-        prunes++;
+        stats->prunes++;
         if (startingSolutionIsBest && rn != 0)
         {
             ++numBranchesPrunedByStartingSolution;
@@ -3959,16 +4610,42 @@ void branch_and_reduce_algorithm::rec(timer &t, double time_limit)
     }
     if (rn == 0) // G is empty
     {
-        if (debug >= 2 && rootDepth <= maxDepth)
+        if (config.debug >= 2 && rootDepth <= maxDepth)
             fprintf(stderr, "%sopt: %d -> %d\n", debugString().c_str(), opt, crt);
         opt = crt;
+        share_opt();
         y = x;
         startingSolutionIsBest = false;
         reverse();
         return;
     }
+    if (rn <= config.SMALL_N) // small kernel, solved without further branching
+    {
+        if (rn <= 64)
+            solve_small(smallKernel1, t, time_limit);
+        else if (rn <= 128)
+            solve_small(smallKernel2, t, time_limit);
+        else
+            solve_small(smallKernel4, t, time_limit);
+        return;
+    }
     if (decompose(t, time_limit)) // check for CC's
         return;
+
+    // the subtree only sees the remaining vertices, so once the graph shrank enough
+    // they are renumbered into a dense prefix with lists without removed vertices
+    if (n > 100 && rn < compactN * SHRINK_COMPACT)
+    {
+        int oldCompactN = compactN;
+        compactN = rn;
+        relabeling r;
+        relabel(r);
+        branching(t, time_limit); // branch
+        undo_relabel(r);
+        compactN = oldCompactN;
+        return;
+    }
+    compact_dead_lists();
     branching(t, time_limit); // branch
 }
 
@@ -3989,22 +4666,148 @@ void branch_and_reduce_algorithm::addStartingSolution(std::vector<int> solution,
     numBranchesPrunedByStartingSolution = 0;
 }
 
+// degree one and degree two rules on a block, vertices with neighbours outside the block are frozen:
+// they are never reduced themselves and never folded into, only taken as neighbours of a vertex in the IS.
+// ops gets the rules in the order they were applied, {v, -1, -1} for set(v, 0) and {v, u, w} for a fold of v
+void branch_and_reduce_algorithm::reduce_block(std::vector<char> const &frozen, std::vector<std::array<int, 3>> &ops)
+{
+    std::vector<int> q;
+    for (int v = 0; v < n; v++)
+        if (!frozen[v] && deg(v) <= 2)
+            q.push_back(v);
+    auto touch = [&](int v) {
+        for (int u : adj[v])
+            if (x[u] < 0 && !frozen[u] && deg(u) <= 2)
+                q.push_back(u);
+    };
+    while (!q.empty())
+    {
+        int v = q.back();
+        q.pop_back();
+        if (x[v] >= 0 || deg(v) > 2)
+            continue;
+        int p = 0, nb[2];
+        for (int u : adj[v])
+            if (x[u] < 0)
+                nb[p++] = u;
+        bool take = p < 2;
+        if (!take)
+            for (int u : adj[nb[0]])
+                if (u == nb[1]) // triangle
+                    take = true;
+        if (take)
+        {
+            set(v, 0);
+            ops.push_back({v, -1, -1});
+            for (int i = 0; i < p; i++)
+                touch(nb[i]);
+        }
+        else if (!frozen[nb[0]] && !frozen[nb[1]])
+        {
+            compute_fold(std::vector<int>{v}, std::vector<int>{nb[0], nb[1]});
+            ops.push_back({v, nb[0], nb[1]});
+            if (deg(nb[0]) <= 2)
+                q.push_back(nb[0]);
+            touch(nb[0]);
+        }
+    }
+}
+
+// initial kernelization of huge inputs: METIS splits the graph into blocks, the degree one and two rules run
+// on the blocks in parallel and are then replayed here in the same order. A rule only reads and changes its
+// own block, so the replay gives the kernel and modification log of applying them one by one, and reduce()
+// in rec() finishes the boundaries together with all other rules.
+void branch_and_reduce_algorithm::partition_reduce()
+{
+    thread_pool *pool = shared_pool(config);
+    int32_t nn;
+    std::vector<int32_t> xadj, adjncy;
+    std::vector<int> rm;
+    convert_to_metis(&nn, xadj, adjncy, rm);
+
+    idx_t options[METIS_NOPTIONS];
+    METIS_SetDefaultOptions(options);
+    options[METIS_OPTION_SEED] = 42;
+    int32_t ncon = 1;
+    int32_t nparts = pool->size() * 4;
+    int32_t cut_size;
+    std::vector<int32_t> part(nn);
+    METIS_PartGraphRecursive(&nn, &ncon, xadj.data(), adjncy.data(), NULL, NULL, NULL, &nparts, NULL, NULL, options, &cut_size, part.data());
+
+    std::vector<int> block(n, -1), local(n, -1);
+    std::vector<std::vector<int>> vs(nparts);
+    for (int i = 0; i < nn; i++)
+    {
+        int v = rm[i];
+        block[v] = part[i];
+        local[v] = vs[part[i]].size();
+        vs[part[i]].push_back(v);
+    }
+
+    std::vector<std::vector<std::array<int, 3>>> ops(nparts);
+    std::atomic<int> pending(nparts);
+    for (int b = 0; b < nparts; b++)
+    {
+        pool->submit([this, b, &vs, &block, &local, &ops, &pending]() {
+            int bn = vs[b].size();
+            std::vector<long long> offsets(bn + 1, 0);
+            std::vector<int> nbr;
+            std::vector<char> frozen(bn, 0);
+            for (int i = 0; i < bn; i++)
+            {
+                for (int u : adj[vs[b][i]])
+                    if (x[u] < 0)
+                    {
+                        if (block[u] == b)
+                            nbr.push_back(local[u]);
+                        else
+                            frozen[i] = 1;
+                    }
+                offsets[i + 1] = nbr.size();
+            }
+            dyn_csr badj(offsets, nbr);
+            solver_config bconfig = config;
+            bconfig.USE_DEPENDENCY_CHECKING = false;
+            branch_and_reduce_algorithm sub(badj, bn, bconfig);
+            sub.reduce_block(frozen, ops[b]);
+            for (auto &op : ops[b])
+                for (int &v : op)
+                    if (v >= 0)
+                        v = vs[b][v];
+            pending--;
+        });
+    }
+    pool->help_while([&pending]() { return pending > 0; });
+
+    int oldn = rn;
+    for (int b = 0; b < nparts; b++)
+        for (auto const &op : ops[b])
+        {
+            if (op[1] < 0)
+                set(op[0], 0);
+            else
+                compute_fold(std::vector<int>{op[0]}, std::vector<int>{op[1], op[2]});
+        }
+    if (config.debug >= 3 && depth <= maxDepth)
+        fprintf(stderr, "%spartition (%d blocks, cut %d): %d -> %d\n", debugString().c_str(), nparts, cut_size, oldn, rn);
+}
+
 int branch_and_reduce_algorithm::solve(timer &t, double time_limit)
 {
-    if (t.elapsed() >= time_limit)
+    if (stopped(t, time_limit))
         return -1;
 
     // PrintState();
-    if (LOWER_BOUND >= 2 && REDUCTION <= 0 && !outputLP)
+    if (config.LOWER_BOUND >= 2 && config.REDUCTION <= 0 && !config.outputLP)
     {
         cerr << "LP/cycle lower bounds require LP reduction." << endl
              << flush;
         assert(0);
     }
     rootDepth = depth;
-    if (outputLP)
+    if (config.outputLP)
     {
-        if (REDUCTION < 0)
+        if (config.REDUCTION < 0)
         {
             lpReduction();
         }
@@ -4015,10 +4818,12 @@ int branch_and_reduce_algorithm::solve(timer &t, double time_limit)
         printf("%.1f\n", crt + rn / 2.0);
         return opt;
     }
+    if (config.PARTITION_N > 0 && depth == 0 && modifiedN == 0 && rn >= config.PARTITION_N && shared_pool(config) != nullptr)
+        partition_reduce();
     rec(t, time_limit);
-    if (debug >= 2 && depth <= maxDepth)
+    if (config.debug >= 2 && depth <= maxDepth)
         fprintf(stderr, "%sopt: %d\n", debugString().c_str(), opt);
-    if (t.elapsed() >= time_limit)
+    if (stopped(t, time_limit))
         return -1;
     else
         return opt;
@@ -4088,15 +4893,15 @@ void branch_and_reduce_algorithm::reduce_graph()
     int oldn = rn;
     for (;;)
     {
-        if (REDUCTION >= 0)
+        if (config.REDUCTION >= 0)
             deg1Reduction();
-        if (REDUCTION >= 0 && REDUCTION < 2 && dominateReduction())
+        if (config.REDUCTION >= 0 && config.REDUCTION < 2 && dominateReduction())
             continue;
-        if (REDUCTION >= 2 && unconfinedReduction())
+        if (config.REDUCTION >= 2 && unconfinedReduction())
             continue;
-        if (REDUCTION >= 1 && lpReduction())
+        if (config.REDUCTION >= 1 && lpReduction())
             continue;
-        if (REDUCTION >= 3)
+        if (config.REDUCTION >= 3)
         {
             int r = packingReduction();
             if (r < 0)
@@ -4104,20 +4909,20 @@ void branch_and_reduce_algorithm::reduce_graph()
             if (r > 0)
                 continue;
         }
-        if (REDUCTION >= 1 && fold2Reduction())
+        if (config.REDUCTION >= 1 && fold2Reduction())
             continue;
-        if (REDUCTION >= 2 && twinReduction())
+        if (config.REDUCTION >= 2 && twinReduction())
             continue;
-        if (REDUCTION >= 2 && funnelReduction())
+        if (config.REDUCTION >= 2 && funnelReduction())
             continue;
-        if (REDUCTION >= 2 && deskReduction())
+        if (config.REDUCTION >= 2 && deskReduction())
             continue;
         break;
     }
-    if (debug >= 2 && depth <= maxDepth && oldn != rn)
+    if (config.debug >= 2 && depth <= maxDepth && oldn != rn)
         fprintf(stderr, "%sreduce: %d -> %d\n", debugString().c_str(), oldn, rn);
     size_t low_degree_count(0);
-    for (int v = 0; v < n; v++)
+    for (int v : remaining_vertices())
         if (x[v] < 0)
         {
             if (deg(v) <= 1)
@@ -4133,7 +4938,12 @@ void branch_and_reduce_algorithm::initial_reduce_graph()
 {
     reduce_graph();
     snapshotX = x;
-    reductionSnapshotSize = modifieds.size();
+    reductionSnapshotSize = modifiedN;
+    snapshotRn = rn;
+    snapshotPacking = packing.size();
+    snapshotTrail = adjTrail.size();
+    snapshotIn = in;
+    snapshotOut = out;
 }
 
 size_t branch_and_reduce_algorithm::get_current_is_size() const
@@ -4143,7 +4953,7 @@ size_t branch_and_reduce_algorithm::get_current_is_size() const
 
     for (int i = modifiedN - 1; i >= 0; i--)
     {
-        modifieds[i]->reverse(x2);
+        reverse_modified(modifieds[i], x2);
     }
 
     size_t current_is_size(0);
@@ -4181,7 +4991,7 @@ bool branch_and_reduce_algorithm::folded_vertices_exist() const
 
     for (int i = modifiedN - 1; i >= 0; i--)
     {
-        modifieds[i]->reverse(x2);
+        reverse_modified(modifieds[i], x2);
     }
 
     for (int const i : x2)
@@ -4222,7 +5032,7 @@ std::vector<int> branch_and_reduce_algorithm::compute_maximal_is()
 
     for (int i = modifiedN - 1; i >= 0; i--)
     {
-        modifieds[i]->reverse(x2);
+        reverse_modified(modifieds[i], x2);
     }
 
     size_t current_is_size(0);
@@ -4275,16 +5085,22 @@ size_t branch_and_reduce_algorithm::compute_alternative_maximal_is_size()
     return sizeOfIS + numberOfFoldedVertices / 2;
 }
 
+// undoes all removals, modifications and compacted lists since initial_reduce_graph()
 void branch_and_reduce_algorithm::restore_to_snapshot()
 {
-
-    while (modifiedN > reductionSnapshotSize)
-    {
-        modifieds[--modifiedN]->restore();
-        modifieds[modifiedN] = shared_ptr<modified>();
-    }
-
-    x = snapshotX;
+    restore(snapshotRn);
+    while (adjTrail.size() > snapshotTrail)
+        undo_compact();
+    while (packing.size() > snapshotPacking)
+        popPacking();
+    assert(modifiedN == reductionSnapshotSize);
+    assert(x == snapshotX);
+
+    // the matching is not undone while branching, the one of the snapshot is still valid
+    in = snapshotIn;
+    out = snapshotOut;
+    gcnMark.clear(); // the cached evaluation does not know what changed
+    gcnChanged.clear();
 }
 
 size_t branch_and_reduce_algorithm::number_of_nodes_remaining() const
@@ -4361,7 +5177,7 @@ void branch_and_reduce_algorithm::extend_finer_is(std::vector<bool> &independent
     // undo reductions
     for (int i = modifiedN - 1; i >= 0; i--)
     {
-        modifieds[i]->reverse(x2);
+        reverse_modified(modifieds[i], x2);
     }
 
     // update full independent set
@@ -4564,7 +5380,7 @@ void branch_and_reduce_algorithm::convert_to_adj(std::vector<std::vector<int>> &
     }
 }
 
-// NEW BRANCHING RULES
+// NEW config.BRANCHING RULES
 
 int branch_and_reduce_algorithm::get_articulation_point()
 {
@@ -4832,9 +5648,9 @@ void branch_and_reduce_algorithm::get_stcut_vertices()
     cut.clear();
     // choose s and t with max deg
     NodeID v1 = get_max_deg_vtx();
-    x[v1] = 0;
+    remove_vertex(v1, 0);
     NodeID v2 = get_max_deg_vtx();
-    x[v1] = -1;
+    restore_vertex(v1);
 
     s = v1;
     t = v2;
@@ -4892,8 +5708,8 @@ void branch_and_reduce_algorithm::get_stcut_vertices()
     }
 
     double perc = (double)res.size() / (double)number_of_nodes_remaining();
-    unsigned int max_size = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)((((double)(-TUNING_PARAM1)) / 100) * (double)rn);
-    if (cut.size() > max_size || perc < TUNING_PARAM2 || perc > (1.0 - TUNING_PARAM2))
+    unsigned int max_size = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)((((double)(-config.TUNING_PARAM1)) / 100) * (double)rn);
+    if (cut.size() > max_size || perc < config.TUNING_PARAM2 || perc > (1.0 - config.TUNING_PARAM2))
     {
         // to big, use max. deg. vertex instead
         cut.clear();
@@ -4905,9 +5721,9 @@ void branch_and_reduce_algorithm::get_stcut_vertices_n()
     cut.clear();
     // choose s and t with max deg
     NodeID v1 = get_max_deg_vtx();
-    x[v1] = 0;
+    remove_vertex(v1, 0);
     NodeID v2 = get_max_deg_vtx();
-    x[v1] = -1;
+    restore_vertex(v1);
 
     s = v1;
     t = v2;
@@ -4966,7 +5782,7 @@ void branch_and_reduce_algorithm::get_stcut_vertices_n()
     }
 
     double perc = (double)res.size() / (double)number_of_nodes_remaining();
-    // if (perc < TUNING_PARAM2 || perc > (1.0 - TUNING_PARAM2))
+    // if (perc < config.TUNING_PARAM2 || perc > (1.0 - config.TUNING_PARAM2))
     // {
     //     // to big, use max. deg. vertex instead
     //     cut.clear();
@@ -4976,33 +5792,36 @@ void branch_and_reduce_algorithm::get_stcut_vertices_n()
 
 int inline branch_and_reduce_algorithm::get_max_deg_vtx()
 {
-    int v, dv = -1;
-    long long minE = 0;
-    for (int u = 0; u < n; u++)
-        if (x[u] < 0)
-        {
-            int degree = deg(u);
-            if (dv > degree)
-                continue;
-            long long e = 0;
-            used.clear();
-            for (int w : adj[u])
-                if (x[w] < 0)
-                    used.add(w);
-            for (int w : adj[u])
-                if (x[w] < 0)
-                {
-                    for (int w2 : adj[w])
-                        if (x[w2] < 0 && used.get(w2))
-                            e++;
-                }
-            if (dv < degree || (dv == degree && minE > e))
+    // only the top bucket can contain the result, ties are broken by
+    // min. #edges in N(u) and then by the smallest id
+    int dv = degBuckets.max();
+    if (dv < 0)
+        return -1;
+    int v = degBuckets.first(dv);
+    if (degBuckets.succ(v) < 0)
+        return v;
+
+    long long minE = -1;
+    for (int u = v; u >= 0; u = degBuckets.succ(u))
+    {
+        long long e = 0;
+        used.clear();
+        for (int w : adj[u])
+            if (x[w] < 0)
+                used.add(w);
+        for (int w : adj[u])
+            if (x[w] < 0)
             {
-                dv = degree;
-                minE = e;
-                v = u;
+                for (int w2 : adj[w])
+                    if (x[w2] < 0 && used.get(w2))
+                        e++;
             }
+        if (minE < 0 || minE > e || (minE == e && u < v))
+        {
+            minE = e;
+            v = u;
         }
+    }
 
     return v;
 }
@@ -5010,9 +5829,9 @@ int inline branch_and_reduce_algorithm::get_max_deg_vtx()
 void branch_and_reduce_algorithm::compute_nd_order_cutter()
 {
 #ifdef USE_IFC
-    double balance = TUNING_PARAM2;
-    int nd_threshold = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)(((double)(-TUNING_PARAM1) / 100.0) * rn);
-    int max_level = (TUNING_PARAM3 > 0) ? TUNING_PARAM3 : floor(log2(n)) + TUNING_PARAM3;
+    double balance = config.TUNING_PARAM2;
+    int nd_threshold = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)(((double)(-config.TUNING_PARAM1) / 100.0) * rn);
+    int max_level = (config.TUNING_PARAM3 > 0) ? config.TUNING_PARAM3 : floor(log2(n)) + config.TUNING_PARAM3;
 
     std::vector<std::vector<int>> new_adj;
     std::vector<int> map;
@@ -5087,9 +5906,9 @@ int branch_and_reduce_algorithm::max_nh_vtx()
 
 void branch_and_reduce_algorithm::compute_nd_order()
 {
-    double balance = TUNING_PARAM2;
-    int nd_threshold = TUNING_PARAM1 >= 0 ? TUNING_PARAM1 : (int)(((double)(-TUNING_PARAM1) / 100.0) * rn);
-    int max_level = (TUNING_PARAM3 > 0) ? TUNING_PARAM3 : floor(log2(n)) + TUNING_PARAM3;
+    double balance = config.TUNING_PARAM2;
+    int nd_threshold = config.TUNING_PARAM1 >= 0 ? config.TUNING_PARAM1 : (int)(((double)(-config.TUNING_PARAM1) / 100.0) * rn);
+    int max_level = (config.TUNING_PARAM3 > 0) ? config.TUNING_PARAM3 : floor(log2(n)) + config.TUNING_PARAM3;
     max_level = (max_level > 0) ? max_level : 1;
 
     int p = pow(2, max_level);
@@ -5116,7 +5935,7 @@ void branch_and_reduce_algorithm::compute_nd_order()
     options[METIS_OPTION_SEED] = 42;
     options[METIS_OPTION_UFACTOR] = (int)(balance * 1000.0);
 
-    if (BRANCHING == 13)
+    if (config.BRANCHING == 13)
     {
         int r = METIS_NodeNDP(n, xadj, adjncy, NULL, p, NULL, perm, iperm, sizes);
     }
@@ -5255,7 +6074,7 @@ void branch_and_reduce_algorithm::compute_metis_sep()
     idx_t options[METIS_NOPTIONS];
     METIS_SetDefaultOptions(options);
     options[METIS_OPTION_SEED] = 42;
-    int balance = (1.0-(1.0-TUNING_PARAM2)/TUNING_PARAM2) * -1000;
+    int balance = (1.0-(1.0-config.TUNING_PARAM2)/config.TUNING_PARAM2) * -1000;
     options[METIS_OPTION_UFACTOR] = balance;
 
     int32_t ncon = 1;
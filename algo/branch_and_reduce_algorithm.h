@@ -24,7 +24,11 @@
 // local includes
 #include "fast_set.h"
 #include "modified.h"
+#include "small_kernel.h"
+#include "solver_config.h"
 #include "timer.h"
+#include "data_structures/dyn_csr.h"
+#include "data_structures/degree_buckets.h"
 
 #include "max_flow.h"
 #ifdef USE_IFC
@@ -33,14 +37,17 @@
 #include "metis.h"
 
 #include "tools/debug_info_logger.h"
+#include "tools/thread_pool.h"
 
 // system includes
 #include <vector>
+#include <array>
 #include <stack> 
 #include <set>
 #include <string>
 #include <memory>
 #include <cstring>
+#include <atomic>
 
 #include <iostream>
 #include <fstream>
@@ -54,54 +61,29 @@
 
 #include "../gnn/gcn.h"
 
+class remote_pool;
+
 class branch_and_reduce_algorithm
 {
-	friend class modified;
-	friend class fold;
-	friend class alternative;
-
 public:
-	static int REDUCTION;
-	static int LOWER_BOUND;
-	static int BRANCHING;
-	static bool outputLP;
-
-	// 1 for extra decompose step
-	static int EXTRA_DECOMP;
-	static int ND_LEVEL;
-	static long TUNING_PARAM1;
-	static double TUNING_PARAM2;
-	static long TUNING_PARAM3;
-
-	// statistics
-	static long defaultBranchings;
-	static bool defaultBranch;
-	static long defaultPicks;
-	static long stratPicks;
-	static long nDecomps;
+	solver_config config;
+
+	// statistics of the whole solve, shared with the solvers for components and forks
+	std::shared_ptr<solver_stats> stats;
+	bool defaultBranch = false;
 
 	debug_info_logger* logger;
 
-	static long prunes;
-	static long ro;
-
-	static void resetStatistics()
-	{
-		nBranchings = 0;
-		defaultBranch = false;
-		defaultBranchings = 0;
-		defaultPicks = 0;
-		stratPicks = 0;
-		nDecomps = 0;
-	}
+	// worker processes that take over subtrees like the forks do, nullptr for a local search
+	remote_pool *remote = nullptr;
 
 	//std::vector<int> optBranchOrder;
 	//std::vector<std::vector<int>>  branchTree;
 
-	std::vector<std::vector<int>> adj;
-	static long nBranchings;
-	static int debug;
+	dyn_csr adj;
 	double SHRINK;
+	double COMPACT;
+	double SHRINK_COMPACT;
 	int depth;
 	int maxDepth;
 	int max_depth = 0;
@@ -111,6 +93,33 @@ public:
 
 	gcn model;
 	gcn_data model_data;
+	std::vector<int> new_id, old_id; // vertex ids of the remaining graph given to gcn_eval
+
+	/**
+	 * Activations of the last evaluation of the model with vertex ids as row ids. The model reads adj
+	 * and liveDeg directly, removed vertices get scale 0. gcnChanged collects the vertices whose live
+	 * neighbourhood changed since then, tracking is off while gcnMark is empty.
+	 */
+	gcn_cache gcnCache = {};
+	std::vector<int> gcnChanged;
+	std::vector<char> gcnMark;
+	inline void gcn_touch(int v)
+	{
+		if (!gcnMark.empty() && !gcnMark[v])
+		{
+			gcnMark[v] = 1;
+			gcnChanged.push_back(v);
+		}
+	}
+	int gcn_pick();
+
+	/**
+	 * --check-precision: the fp32 model that the picks of a reduced-precision model are compared with,
+	 * params is NULL without the check. Its activations have vertex ids as row ids, like gcnCache.
+	 */
+	gcn gcnRef = {};
+	gcn_cache gcnRefCache = {};
+	void gcn_check(int v);
 
 	/**
 	 * current best solution
@@ -118,12 +127,53 @@ public:
 	int opt;
 	std::vector<int> y;
 
+	/**
+	 * best solution size found by any fork of this solver, opt is only lowered by own solutions
+	 */
+	std::shared_ptr<std::atomic<int>> sharedOpt;
+
+	/**
+	 * solver of the node a component was split off, the component only improves it with a cover
+	 * smaller than outer->cutoff() - outerBase (outerBase covers the rest of the node)
+	 */
+	branch_and_reduce_algorithm const *outer = nullptr;
+	int outerBase = 0;
+
+	// bound used for pruning
+	int cutoff() const
+	{
+		int b = sharedOpt ? std::min(opt, sharedOpt->load(std::memory_order_relaxed)) : opt;
+		return outer != nullptr ? std::min(b, outer->cutoff() - outerBase) : b;
+	}
+	void share_opt();
+
+	/**
+	 * set when another solver of a portfolio finished, the search then stops as on a timeout
+	 */
+	std::shared_ptr<std::atomic<bool>> cancel;
+	bool stopped(timer &t, double time_limit) { return t.elapsed() >= time_limit || (cancel && *cancel); }
+
 	/**
 	 * current solution (-1: not determined, 0: not in the vc, 1: in the vc, 2: removed by foldings)
 	 */
 	int crt;
 	std::vector<int> x;
 
+	/**
+	 * #neighbours u with x[u] < 0, exact for every vertex with x[v] < 0
+	 */
+	std::vector<int> liveDeg;
+
+	/**
+	 * remaining vertices bucketed by live degree, used to pick max. deg. vertices
+	 */
+	degree_buckets degBuckets;
+
+	/**
+	 * set of remaining vertices, kept in sync with x
+	 */
+	ArraySet liveSet;
+
 	/**
 	 * #remaining vertices
 	 */
@@ -144,8 +194,55 @@ public:
 
 	std::vector<int> modTmp;
 
-	std::vector<std::shared_ptr<modified>> modifieds;
+	/**
+	 * rn when the vertices were last renumbered on the current path
+	 */
+	int compactN;
+
+	/**
+	 * all remaining vertices have ids below denseN
+	 */
+	int denseN;
+
+	/**
+	 * current id of the vertex that had id 1 before any renumbering, the packing
+	 * reductions give up on it and the relabeled subtrees have to do the same
+	 */
+	int vertexOne;
+
+	/**
+	 * Renumbering of the vertices by relabel(): the remaining vertices get the ids 0, ..., rn - 1
+	 * and lists without removed vertices, the removed ones the ids rn, ..., n - 1, both in their old
+	 * order. undo_relabel() puts the old ids and lists back once the subtree is searched.
+	 */
+	struct relabeling
+	{
+		std::vector<int> oldId; // new id -> old id
+		std::vector<dyn_csr::slot> lists; // lists of the old ids
+		dyn_csr::position top;
+		int denseN;
+	};
+
+	/**
+	 * undo trail for compacted lists, an entry is undone by restore() before
+	 * any vertex that was removed when it was created returns
+	 */
+	struct adj_change
+	{
+		int v;
+		dyn_csr::slot old;
+		int rn;
+		dyn_csr::position top;
+	};
+	std::vector<adj_change> adjTrail;
+
+	/**
+	 * modification log, see modified.h
+	 */
+	std::vector<modified> modifieds;
 	int modifiedN;
+	std::vector<int> modVertices;
+	std::vector<dyn_csr::slot> modAdj;
 
 	/**
 	 * Packing constraints
@@ -155,14 +252,69 @@ public:
 
 	std::vector<int> vRestore;
 
+	/**
+	 * state after initial_reduce_graph(), restore_to_snapshot() goes back to it
+	 */
 	int reductionSnapshotSize;
 	std::vector<int> snapshotX;
+	int snapshotRn;
+	unsigned int snapshotPacking;
+	size_t snapshotTrail;
+	std::vector<int> snapshotIn, snapshotOut;
 
-	branch_and_reduce_algorithm(std::vector<std::vector<int>>& _adj, int const _N);
+	branch_and_reduce_algorithm(dyn_csr& _adj, int const _N, solver_config const &_config = solver_config());
+	~branch_and_reduce_algorithm();
 
 	int deg(int v);
 	void set(int v, int a);
 
+	// x[v] = a for a remaining vertex v, the neighbours lose v from their live degree
+	inline void remove_vertex(int v, int a)
+	{
+		degBuckets.remove(v);
+		liveSet.Remove(v);
+		x[v] = a;
+		gcn_touch(v);
+		for (int u : adj[v])
+		{
+			liveDeg[u]--;
+			if (x[u] < 0)
+				degBuckets.change(u, liveDeg[u]);
+		}
+	}
+
+	// reverts remove_vertex(v, a)
+	inline void restore_vertex(int v)
+	{
+		x[v] = -1;
+		gcn_touch(v);
+		for (int u : adj[v])
+		{
+			liveDeg[u]++;
+			if (x[u] < 0)
+				degBuckets.change(u, liveDeg[u]);
+		}
+		degBuckets.insert(v, liveDeg[v]);
+		liveSet.Insert(v);
+	}
+
+	// remaining vertices in increasing order, O(rn log rn) deep in the search tree; loops that need no
+	// order iterate liveSet
+	std::vector<int> remaining_vertices() const;
+
+	// recounts the live degree of v, used when v gets a new adjacency list
+	inline void count_deg(int v)
+	{
+		int d = 0;
+		for (int u : adj[v])
+			if (x[u] < 0)
+				d++;
+		liveDeg[v] = d;
+		if (x[v] < 0)
+			degBuckets.change(v, d);
+		gcn_touch(v);
+	}
+
 	fast_set used;
 
 	// helpers for modifying the graph
@@ -170,6 +322,17 @@ public:
 	void compute_alternative(std::vector<int> const &A, std::vector<int> const &B);
 	void restore(int n);
 	void reverse();
+	void push_modified(modified::kind_t kind, int add, int k, int removedBegin, int vsBegin, int adjBegin, dyn_csr::position top);
+	void restore_modified();
+	void reverse_modified(modified const &m, std::vector<int> &x) const;
+	dyn_csr::range mod_removed(modified const &m) { return {modVertices.data() + m.removedBegin, modVertices.data() + m.vsBegin}; }
+	dyn_csr::range mod_vs(modified const &m) { return {modVertices.data() + m.vsBegin, modVertices.data() + m.vsEnd}; }
+	void compact_list(int v);
+	void compact_dead_lists();
+	void undo_compact();
+	void relabel(relabeling &r);
+	void undo_relabel(relabeling &r);
+	void renumber(std::vector<int> const &id);
 
 	// helpers for lpReduction
 	bool dinicDFS(int v);
@@ -195,6 +358,23 @@ public:
 	int cliqueLowerBound();
 	int lowerBound();
 
+	// exact solvers for small kernels, one per bitset width
+	small_kernel<1> smallKernel1;
+	small_kernel<2> smallKernel2;
+	small_kernel<4> smallKernel4;
+	template <int W>
+	void solve_small(small_kernel<W> &sk, timer &t, double time_limit);
+
+	// parallel search
+	static thread_pool *shared_pool(solver_config const &config); // nullptr if there is only one thread
+	branch_and_reduce_algorithm *fork();
+	void exclude(int v, bool hasMirrors);
+	int submit_remote(timer &t, double time_limit);
+	bool finish_remote(int task);
+	void partition_reduce();
+	void reduce_block(std::vector<char> const &frozen, std::vector<std::array<int, 3>> &ops);
+	int parallel_components(thread_pool *pool, std::vector<int> const &remaining, std::vector<int> &id, std::vector<int> &size);
+
 	// recursive methods
 	void branching(timer &t, double time_limit);
 	bool decompose(timer &t, double time_limit);
@@ -316,8 +496,6 @@ public:
 
 
 	// dependency checking
-	static bool USE_DEPENDENCY_CHECKING;
-
 	ArraySet dc_candidates;	
 
 
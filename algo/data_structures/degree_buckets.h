@@ -0,0 +1,85 @@
+#ifndef DEGREE_BUCKETS_H
+#define DEGREE_BUCKETS_H
+
+#include <vector>
+#include <cassert>
+
+/**
+ * Bucket queue over the remaining vertices keyed by their degree.
+ * Every bucket is a doubly linked list, so insert, remove and key changes are O(1).
+ * The maximum is found by walking down from the last known top bucket.
+ */
+class degree_buckets {
+
+	std::vector<int> head;
+	std::vector<int> next;
+	std::vector<int> prev;
+	std::vector<int> key;
+	int top;
+
+public:
+	degree_buckets(int const n = 0) : head(n + 1, -1), next(n, -1), prev(n, -1), key(n, -1), top(-1)
+	{ }
+
+	bool contains(int v) const {
+		return key[v] >= 0;
+	}
+
+	void insert(int v, int d) {
+		assert(key[v] < 0 && d >= 0);
+		if (d >= static_cast<int>(head.size()))
+			head.resize(d + 1, -1);
+		key[v] = d;
+		prev[v] = -1;
+		next[v] = head[d];
+		if (head[d] >= 0)
+			prev[head[d]] = v;
+		head[d] = v;
+		if (d > top)
+			top = d;
+	}
+
+	void remove(int v) {
+		assert(key[v] >= 0);
+		if (prev[v] >= 0)
+			next[prev[v]] = next[v];
+		else
+			head[key[v]] = next[v];
+		if (next[v] >= 0)
+			prev[next[v]] = prev[v];
+		key[v] = -1;
+	}
+
+	void change(int v, int d) {
+		if (key[v] == d)
+			return;
+		remove(v);
+		insert(v, d);
+	}
+
+	void clear() {
+		for (int &h : head)
+			h = -1;
+		for (int &k : key)
+			k = -1;
+		top = -1;
+	}
+
+	// largest key of a vertex in the queue, -1 if empty
+	int max() {
+		while (top >= 0 && head[top] < 0)
+			top--;
+		return top;
+	}
+
+	// iteration over a bucket: for (int v = first(d); v >= 0; v = succ(v))
+	int first(int d) const {
+		return head[d];
+	}
+
+	int succ(int v) const {
+		return next[v];
+	}
+};
+
+#endif // DEGREE_BUCKETS_H
@@ -0,0 +1,145 @@
+#ifndef DYN_CSR_H
+#define DYN_CSR_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+/**
+ * Adjacency array that can be edited while branching.
+ *
+ * All initial lists live in one contiguous neighbour array, vertex v refers to its list by a
+ * (pointer, size) slot. Lists created by folds and alternatives are appended to a chunked arena
+ * and released in LIFO order, so pointers to a list stay valid until the modification that
+ * created it is undone.
+ */
+class dyn_csr {
+
+public:
+    struct slot {
+        int *b;
+        int size;
+    };
+
+    struct range {
+        int *b;
+        int *e;
+
+        int *begin() const { return b; }
+        int *end() const { return e; }
+        int size() const { return e - b; }
+        bool empty() const { return b == e; }
+        int &operator[](int i) const { return b[i]; }
+    };
+
+    // arena top, lists appended after a position are dropped by release(position)
+    struct position {
+        size_t chunk = 0;
+        size_t used = 0;
+    };
+
+    dyn_csr() {}
+
+    dyn_csr(std::vector<std::vector<int>> const &adj)
+    {
+        n = adj.size();
+        size_t m = 0;
+        for (auto const &nb : adj)
+            m += nb.size();
+        own.resize(m);
+        lists.resize(n);
+        int *p = own.data();
+        for (int v = 0; v < n; v++)
+        {
+            std::copy(adj[v].begin(), adj[v].end(), p);
+            lists[v] = {p, static_cast<int>(adj[v].size())};
+            p += adj[v].size();
+        }
+    }
+
+    // takes over the given arrays, offsets has n + 1 entries
+    dyn_csr(std::vector<long long> &offsets, std::vector<int> &nbr)
+    {
+        own.swap(nbr);
+        build(offsets.size() - 1, offsets.data(), own.data());
+    }
+
+    // lists are read from (and edited in) external storage that must outlive this object
+    dyn_csr(int _n, const uint64_t *offsets, int *nbr)
+    {
+        build(_n, offsets, nbr);
+    }
+
+    dyn_csr(dyn_csr &&) = default;
+    dyn_csr &operator=(dyn_csr &&) = default;
+    dyn_csr(const dyn_csr &) = delete;
+    dyn_csr &operator=(const dyn_csr &) = delete;
+
+    void swap(dyn_csr &other) { std::swap(*this, other); }
+
+    int size() const { return n; }
+
+    range operator[](int v) const { return {lists[v].b, lists[v].b + lists[v].size}; }
+
+    slot get(int v) const { return lists[v]; }
+    void set(int v, slot s) { lists[v] = s; }
+
+    // exchanges the slots of all vertices, used to renumber them
+    void swap_slots(std::vector<slot> &s) { lists.swap(s); }
+
+    position top() const { return cur; }
+
+    // copies a list into the arena, the result can be installed with set()
+    slot append(const int *src, int len)
+    {
+        if (cur.chunk >= chunks.size() || cur.used + len > caps[cur.chunk])
+        {
+            if (cur.chunk < chunks.size() && cur.used > 0)
+            {
+                cur.chunk++;
+                cur.used = 0;
+            }
+            if (cur.chunk == chunks.size())
+            {
+                chunks.emplace_back();
+                caps.push_back(0);
+            }
+            if (caps[cur.chunk] < static_cast<size_t>(len))
+            {
+                caps[cur.chunk] = std::max(static_cast<size_t>(len), CHUNK_SIZE);
+                chunks[cur.chunk].reset(new int[caps[cur.chunk]]);
+            }
+        }
+        int *b = chunks[cur.chunk].get() + cur.used;
+        if (len > 0)
+            memcpy(b, src, sizeof(int) * len);
+        cur.used += len;
+        return {b, len};
+    }
+
+    void release(position p) { cur = p; }
+
+private:
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+    template <typename Offset>
+    void build(int _n, const Offset *offsets, int *nbr)
+    {
+        n = _n;
+        lists.resize(n);
+        for (int v = 0; v < n; v++)
+            lists[v] = {nbr + offsets[v], static_cast<int>(offsets[v + 1] - offsets[v])};
+    }
+
+    int n = 0;
+    std::vector<int> own;
+    std::vector<slot> lists;
+
+    std::vector<std::unique_ptr<int[]>> chunks;
+    std::vector<size_t> caps;
+    position cur;
+};
+
+#endif // DYN_CSR_H
@@ -1,6 +1,8 @@
 #ifndef __DEFINITIONS_H__
 #define __DEFINITIONS_H__
 
+#include "data_structures/dyn_csr.h"
+
 typedef int NodeID;
 typedef int PartitionID;
 typedef int EdgeID;
@@ -10,6 +12,6 @@ typedef int EdgeWeight;
 typedef EdgeWeight Gain;
 
 typedef int PartitionConfig;
-typedef std::vector<std::vector<int>> AdjList;
+typedef dyn_csr AdjList;
 
 #endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <queue>
 #include <iostream>
 
+#include "data_structures/dyn_csr.h"
+
 using namespace std;
 
 typedef int NodeID;
@@ -15,7 +17,7 @@ class max_flow_algo
     const int WORK_NODE_TO_EDGES = 4;
 
 public:
-    max_flow_algo(std::vector<std::vector<int>> &adjj, std::vector<int> &x)
+    max_flow_algo(dyn_csr &adjj, std::vector<int> &x)
         : adj(adjj), active(x)
     {
         flow.resize(adj.size());
@@ -337,7 +339,7 @@ private:
     int n;
     int m;
     std::vector<std::vector<FlowType>> flow;
-    std::vector<std::vector<int>> &adj;
+    dyn_csr &adj;
 
     std::vector<int> &active;
 
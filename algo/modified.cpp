@@ -22,107 +22,127 @@
 // system includes
 #include <vector>
 
-modified::modified(int const _add, std::vector<int> &_removed, std::vector<int> &_vs, std::vector<std::vector<int>> &newAdj, branch_and_reduce_algorithm *_pAlg)
-: add(_add)
-, pAlg(_pAlg) 
+// Pushes a log entry for the removed and vs lists written to modVertices since removedBegin.
+// modAdj[adjBegin, ...) holds the new lists of vs, they are swapped with the current ones.
+void branch_and_reduce_algorithm::push_modified(modified::kind_t kind, int add, int k, int removedBegin, int vsBegin, int adjBegin, dyn_csr::position top)
 {
-    removed.swap(_removed);
-    vs.swap(_vs);
-    oldAdj.resize(vs.size());
-    pAlg->crt += add;
-    for (int i = 0; i < static_cast<int>(removed.size()); i++) pAlg->vRestore[--(pAlg->rn)] = -1;
-    for (int v : removed) {
-        assert(pAlg->x[v] < 0);
-        pAlg->x[v] = 2;
+    modified &m = modifieds[modifiedN++];
+    m.kind = kind;
+    m.add = add;
+    m.k = k;
+    m.foldingMapAdd = -1;
+    m.removedBegin = removedBegin;
+    m.vsBegin = vsBegin;
+    m.vsEnd = modVertices.size();
+    m.adjBegin = adjBegin;
+    m.top = top;
+    if (adjBegin < 0)
+        return;
+
+    crt += add;
+    for (int i = m.removedBegin; i < m.vsBegin; i++) vRestore[--rn] = -1;
+    for (int i = m.removedBegin; i < m.vsBegin; i++) {
+        int v = modVertices[i];
+        assert(x[v] < 0);
+        remove_vertex(v, 2);
     }
-    for (int i = 0; i < static_cast<int>(vs.size()); i++) {
-        oldAdj[i].swap(pAlg->adj[vs[i]]);
-        pAlg->adj[vs[i]].swap(newAdj[i]);
-    }    
-}
+    for (int i = 0; i < m.vsSize(); i++) {
+        int v = modVertices[m.vsBegin + i];
+        dyn_csr::slot s = adj.get(v);
+        adj.set(v, modAdj[adjBegin + i]);
+        modAdj[adjBegin + i] = s;
+    }
+    for (int i = m.vsBegin; i < m.vsEnd; i++) count_deg(modVertices[i]);
 
-modified::modified(std::vector<int> &_removed, std::vector<int> &_vs, branch_and_reduce_algorithm *_pAlg)
-: add(0)
-, pAlg(_pAlg)
-{
-    removed.swap(_removed);
-    vs.swap(_vs);
+    if (config.USE_DEPENDENCY_CHECKING) {
+        m.foldingMapAdd = 0;
+        for (int i = m.removedBegin; i < m.vsBegin; i++) {
+            int v = modVertices[i];
+            if (packingMap[v].size() != 0) {
+                m.foldingMapAdd += 1;
+                if (kind == modified::FOLD) {
+                    foldingMap[modVertices[m.vsBegin]].push_back(v);
+                } else {
+                    for (int j = m.vsBegin; j < m.vsEnd; j++)
+                        foldingMap[modVertices[j]].emplace_back(v);
+                }
+            }
+        }
+    }
 }
 
-void modified::restore() {
-    pAlg->crt -= add;
-    pAlg->rn += removed.size();
-    for (int v : removed) pAlg->x[v] = -1;
-    for (int i = 0; i < static_cast<int>(vs.size()); i++) {
-        pAlg->adj[vs[i]] = oldAdj[i];
-        int inV = pAlg->in[vs[i]], outV = pAlg->out[vs[i]];
-        for (int u : pAlg->adj[vs[i]]) {
+// undoes the last log entry
+void branch_and_reduce_algorithm::restore_modified() {
+    modified &m = modifieds[--modifiedN];
+    assert(m.adjBegin >= 0);
+
+    crt -= m.add;
+    rn += m.removedSize();
+    for (int i = m.removedBegin; i < m.vsBegin; i++) restore_vertex(modVertices[i]);
+    for (int i = 0; i < m.vsSize(); i++) {
+        int v = modVertices[m.vsBegin + i];
+        adj.set(v, modAdj[m.adjBegin + i]);
+        count_deg(v);
+        int inV = in[v], outV = out[v];
+        for (int u : adj[v]) {
             if (u == inV) inV = -1;
             if (u == outV) outV = -1;
         }
         if (inV >= 0) {
-            pAlg->out[pAlg->in[vs[i]]] = -1;
-            pAlg->in[vs[i]] = -1;
+            out[in[v]] = -1;
+            in[v] = -1;
         }
         if (outV >= 0) {
-            pAlg->in[pAlg->out[vs[i]]] = -1;
-            pAlg->out[vs[i]] = -1;
+            in[out[v]] = -1;
+            out[v] = -1;
         }
     }
-}
-
-fold::fold(int const add, std::vector<int> &_removed, std::vector<int> &_vs, std::vector<std::vector<int>> &newAdj, branch_and_reduce_algorithm *_pAlg)
-    : modified(add, _removed, _vs, newAdj, _pAlg)
-    { 
-        if (pAlg->USE_DEPENDENCY_CHECKING) {
-            foldingMapAdd = 0;
+    adj.release(m.top);
 
-            for (int v : removed) {
-                if (pAlg->packingMap[v].size() != 0) {
-                    pAlg->foldingMap[vs[0]].push_back(v);
-                    foldingMapAdd += 1;
-                }
-            }        
+    if (config.USE_DEPENDENCY_CHECKING) {
+        int last = m.kind == modified::FOLD ? m.vsBegin + 1 : m.vsEnd;
+        for (int i = 0; i < m.foldingMapAdd; i++) {
+            for (int j = m.vsBegin; j < last; j++)
+                foldingMap[modVertices[j]].pop_back();
         }
     }
 
-void fold::restore() {
-    modified::restore();
-
-    if (pAlg->USE_DEPENDENCY_CHECKING) {
-        for (int i = 0; i < foldingMapAdd; i++){
-            pAlg->foldingMap[vs[0]].pop_back();
-        }        
-    }
+    modVertices.resize(m.removedBegin);
+    modAdj.resize(m.adjBegin);
 }
 
-alternative::alternative(int const add, std::vector<int> &_removed, std::vector<int> &_vs, std::vector<std::vector<int>> &newAdj, branch_and_reduce_algorithm *_pAlg, int k)
-    : modified(add, _removed, _vs, newAdj, _pAlg)
-    {
-        this->k = k;
-
-        if (pAlg->USE_DEPENDENCY_CHECKING) {
-            foldingMapAdd = 0;
-
-            for (int v : removed) {
-                if (pAlg->packingMap[v].size() != 0) {
-                    foldingMapAdd += 1;
-                    for (int vv : vs) {
-                        pAlg->foldingMap[vv].emplace_back(v);
-                    }
-                }
-            }        
+void branch_and_reduce_algorithm::reverse_modified(modified const &m, std::vector<int> &x) const
+{
+    const int *removed = modVertices.data() + m.removedBegin;
+    const int *vs = modVertices.data() + m.vsBegin;
+    int r = m.removedSize();
+    if (m.kind == modified::FOLD) {
+        int k = r / 2;
+        if (x[vs[0]] == 0) {
+            for (int i = 0; i < k; i++) x[removed[i]] = 1;
+            for (int i = 0; i < k; i++) x[removed[k + i]] = 0;
+        } else if (x[vs[0]] == 1) {
+            for (int i = 0; i < k; i++) x[removed[i]] = 0;
+            for (int i = 0; i < k; i++) x[removed[k + i]] = 1;
         }
+        return;
     }
 
-void alternative::restore() {
-    modified::restore();
-
-    if (pAlg->USE_DEPENDENCY_CHECKING) {
-        for (int i = 0; i < foldingMapAdd; i++) {
-            for (int vv : vs) {
-                pAlg->foldingMap[vv].pop_back();
-            }
-        }  
+    bool A0 = false, A1 = true;
+    bool B0 = false, B1 = true;
+    for (int i = 0; i < m.k; i++) {
+        if (x[vs[i]] == 0) A0 = true;
+        if (x[vs[i]] != 1) A1 = false;
+    }
+    for (int i = m.k; i < m.vsSize(); i++) {
+        if (x[vs[i]] == 0) B0 = true;
+        if (x[vs[i]] != 1) B1 = false;
     }
-}
\ No newline at end of file
+    if (A1 || B0) {
+        for (int i = 0; i < r / 2; i++) x[removed[i]] = 0;
+        for (int i = r / 2; i < r; i++) x[removed[i]] = 1;
+    } else if (B1 || A0) {
+        for (int i = 0; i < r / 2; i++) x[removed[i]] = 1;
+        for (int i = r / 2; i < r; i++) x[removed[i]] = 0;
+    }
+}
@@ -23,93 +23,32 @@
 #include <vector>
 #include <cassert>
 
-class branch_and_reduce_algorithm;
+#include "data_structures/dyn_csr.h"
 
-class modified {
-
-public:
-    int add;
-    std::vector<int> removed;
-    std::vector<int> vs;
-    std::vector<std::vector<int>> oldAdj;
-    branch_and_reduce_algorithm *pAlg;
-
-    int foldingMapAdd = -1;
-
-public:
-    modified(int const add, std::vector<int> &removed, std::vector<int> &vs, std::vector<std::vector<int>> &newAdj, branch_and_reduce_algorithm *_pAlg);
-
-    modified(std::vector<int> &removed, std::vector<int> &vs, branch_and_reduce_algorithm *_pAlg);
-
-    virtual ~modified() {};
-
-    virtual void restore();
-
-    virtual void reverse(std::vector<int> &x) = 0;
-};
-
-class fold : public modified
+/**
+ * Entry of the modification log of a solver, either a fold or an alternative.
+ *
+ * The entry only stores offsets: removed and vs are consecutive spans of the solver's
+ * modVertices buffer and the adjacency slots of vs are kept in modAdj. Entries are
+ * pushed and popped in LIFO order, so undoing one just truncates both buffers.
+ */
+struct modified
 {
+    enum kind_t { FOLD, ALTERNATIVE };
 
-public:
-    fold(int const add, std::vector<int> &removed, std::vector<int> &vs, std::vector<std::vector<int>> &newAdj, branch_and_reduce_algorithm *_pAlg);
-
-    fold(std::vector<int> &removed, std::vector<int> &vs, branch_and_reduce_algorithm *_pAlg)
-    : modified(removed, vs, _pAlg)
-    { }
-
-    virtual ~fold() {}
-
-    void restore() override;
-
-    virtual void reverse(std::vector<int> &x) {
-        int k = removed.size() / 2;
-        if (x[vs[0]] == 0) {
-            for (int i = 0; i < k; i++) x[removed[i]] = 1;
-            for (int i = 0; i < k; i++) x[removed[k + i]] = 0;
-        } else if (x[vs[0]] == 1) {
-            for (int i = 0; i < k; i++) x[removed[i]] = 0;
-            for (int i = 0; i < k; i++) x[removed[k + i]] = 1;
-        }
-    }
-};
-
-class alternative : public modified {
-
-public:
-    int k;
-
-    alternative(int const add, std::vector<int> &removed, std::vector<int> &vs, std::vector<std::vector<int>> &newAdj, branch_and_reduce_algorithm *_pAlg, int k);
-
-    alternative(std::vector<int> &removed, std::vector<int> &vs, branch_and_reduce_algorithm *_pAlg, int k)
-    : modified(removed, vs, _pAlg)
-    {
-        this->k = k;
-    }
-
-    virtual ~alternative() {}
+    kind_t kind;
+    int add;
+    int k; // alternative: vs[0, k) are the neighbours of A, the rest the ones of B
+    int foldingMapAdd;
 
-    void restore() override;
+    int removedBegin; // removed = modVertices[removedBegin, vsBegin)
+    int vsBegin;      // vs = modVertices[vsBegin, vsEnd)
+    int vsEnd;
+    int adjBegin;     // slots replaced in adj, -1 for entries that never changed the graph
+    dyn_csr::position top; // arena position before the new lists were appended
 
-    void reverse(std::vector<int> &x) {
-        bool A0 = false, A1 = true;
-        bool B0 = false, B1 = true;
-        for (int i = 0; i < k; i++) {
-            if (x[vs[i]] == 0) A0 = true;
-            if (x[vs[i]] != 1) A1 = false;
-        }
-        for (int i = k; i < static_cast<int>(vs.size()); i++) {
-            if (x[vs[i]] == 0) B0 = true;
-            if (x[vs[i]] != 1) B1 = false;
-        }
-        if (A1 || B0) {
-            for (int i = 0; i < static_cast<int>(removed.size()/ 2); i++) x[removed[i]] = 0;
-            for (int i = static_cast<int>(removed.size() / 2); i < static_cast<int>(removed.size()); i++) x[removed[i]] = 1;
-        } else if (B1 || A0) {
-            for (int i = 0; i < static_cast<int>(removed.size() / 2); i++) x[removed[i]] = 1;
-            for (int i = static_cast<int>(removed.size() / 2); i < static_cast<int>(removed.size()); i++) x[removed[i]] = 0;
-        }
-    }
+    int removedSize() const { return vsBegin - removedBegin; }
+    int vsSize() const { return vsEnd - vsBegin; }
 };
 
-#endif // MODIFIED_H
\ No newline at end of file
+#endif // MODIFIED_H
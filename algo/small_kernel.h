@@ -0,0 +1,190 @@
+#ifndef SMALL_KERNEL_H
+#define SMALL_KERNEL_H
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Exact maximum independent set solver for graphs with at most 64 * W vertices.
+ *
+ * Neighbourhoods are bitsets of W words, so every step of the search works on whole
+ * words: vertices of degree <= 1 are taken, the bound is a greedy clique cover
+ * (a coloring of the complement, as in MCS/BBMC) and branching is on a vertex of
+ * maximum degree.
+ */
+template <int W>
+class small_kernel
+{
+	struct bitset
+	{
+		uint64_t w[W];
+
+		void clear() {
+			for (int i = 0; i < W; i++) w[i] = 0;
+		}
+		void add(int v) { w[v >> 6] |= 1ULL << (v & 63); }
+		void remove(int v) { w[v >> 6] &= ~(1ULL << (v & 63)); }
+		bool empty() const {
+			for (int i = 0; i < W; i++)
+				if (w[i] != 0) return false;
+			return true;
+		}
+		int count() const {
+			int c = 0;
+			for (int i = 0; i < W; i++) c += __builtin_popcountll(w[i]);
+			return c;
+		}
+		// |this & b|
+		int count_and(bitset const &b) const {
+			int c = 0;
+			for (int i = 0; i < W; i++) c += __builtin_popcountll(w[i] & b.w[i]);
+			return c;
+		}
+		void and_not(bitset const &b) {
+			for (int i = 0; i < W; i++) w[i] &= ~b.w[i];
+		}
+		void and_with(bitset const &b) {
+			for (int i = 0; i < W; i++) w[i] &= b.w[i];
+		}
+		// lowest element, -1 if empty
+		int first() const {
+			for (int i = 0; i < W; i++)
+				if (w[i] != 0) return (i << 6) + __builtin_ctzll(w[i]);
+			return -1;
+		}
+	};
+
+	int n;
+	std::vector<bitset> nb;
+	std::vector<int> cur;
+
+	int best;
+	std::vector<int> sol;
+
+	// the search gives up once stop() returns true, it is polled every 1024 branchings
+	std::function<bool()> stop;
+	bool stopped;
+	long nodes;
+
+	// size of a greedy clique cover of P, an upper bound on the independent sets in P
+	int cover(bitset P) const
+	{
+		int k = 0;
+		while (!P.empty())
+		{
+			k++;
+			bitset Q = P;
+			while (!Q.empty())
+			{
+				int v = Q.first();
+				P.remove(v);
+				Q.remove(v);
+				Q.and_with(nb[v]);
+			}
+		}
+		return k;
+	}
+
+	void take(bitset &P, int v)
+	{
+		cur.push_back(v);
+		P.and_not(nb[v]);
+		P.remove(v);
+	}
+
+	void rec(bitset P)
+	{
+		int old = cur.size();
+		int v, low;
+		do
+		{
+			// vertices of degree <= 1 are in some maximum independent set
+			v = low = -1;
+			int maxDeg = -1;
+			for (int i = 0; i < W && low < 0; i++)
+				for (uint64_t b = P.w[i]; b != 0; b &= b - 1)
+				{
+					int u = (i << 6) + __builtin_ctzll(b);
+					int d = P.count_and(nb[u]);
+					if (d <= 1)
+					{
+						low = u;
+						break;
+					}
+					if (d > maxDeg)
+					{
+						maxDeg = d;
+						v = u;
+					}
+				}
+			if (low >= 0)
+				take(P, low);
+		} while (low >= 0);
+
+		if (v < 0)
+		{
+			if (static_cast<int>(cur.size()) > best)
+			{
+				best = cur.size();
+				sol = cur;
+			}
+		}
+		else if (static_cast<int>(cur.size()) + cover(P) > best && !stopped)
+		{
+			if ((++nodes & 1023) == 0 && stop())
+				stopped = true;
+			bitset P2 = P;
+			take(P2, v);
+			rec(P2);
+			cur.pop_back();
+			P.remove(v);
+			rec(P);
+		}
+		cur.resize(old);
+	}
+
+public:
+	small_kernel() : n(0), best(0), stopped(false), nodes(0) {}
+
+	// graph on the vertices 0, ..., n - 1
+	void init(int _n)
+	{
+		n = _n;
+		nb.resize(n);
+		for (int v = 0; v < n; v++)
+			nb[v].clear();
+	}
+
+	void add_edge(int u, int v)
+	{
+		nb[u].add(v);
+		nb[v].add(u);
+	}
+
+	// looks for an independent set of more than lb vertices, returns its size or -1 if there is none.
+	// If _stop() ends the search early, the result is the largest set found so far
+	int solve(int lb, std::vector<int> &is, std::function<bool()> _stop)
+	{
+		stop = _stop;
+		stopped = false;
+		nodes = 0;
+		best = lb;
+		sol.clear();
+		cur.clear();
+		bitset P;
+		P.clear();
+		for (int v = 0; v < n; v++)
+			P.add(v);
+		rec(P);
+		if (best <= lb)
+			return -1;
+		is = sol;
+		return best;
+	}
+
+	// branchings of the last solve
+	long branchings() const { return nodes; }
+};
+
+#endif // SMALL_KERNEL_H
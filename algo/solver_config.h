@@ -0,0 +1,60 @@
+#ifndef SOLVER_CONFIG_H
+#define SOLVER_CONFIG_H
+
+#include <atomic>
+
+/**
+ * Parameters of one solve. Every solver created for a component or a fork gets a copy,
+ * so several solves with different parameters can run in one process.
+ */
+struct solver_config
+{
+	int REDUCTION = 3;
+	int LOWER_BOUND = 4;
+	int BRANCHING = 2;
+	bool outputLP = false;
+	int debug = 0;
+
+	// 1 for extra decompose step
+	int EXTRA_DECOMP = 0;
+	long TUNING_PARAM1 = 7;
+	double TUNING_PARAM2 = 0.1;
+	long TUNING_PARAM3 = 10;
+
+	// #threads for solving components in decompose and for the parallel search, 0 for one per core.
+	// With more than one the branch counts vary between runs, so the default is a sequential search
+	int THREADS = 1;
+	// nodes with at least SPLIT_N remaining vertices hand their 0-branch to idle threads, 0 for a sequential search
+	int SPLIT_N = 256;
+	// nodes less than SPECULATE_DEPTH levels below the root always search both branches at once
+	int SPECULATE_DEPTH = 0;
+	// inputs with at least PARTITION_N vertices are split into blocks that are reduced in parallel first, 0 to disable
+	int PARTITION_N = 1 << 20;
+	// decompose finds the components of graphs with at least PARALLEL_CC_N vertices on all threads
+	int PARALLEL_CC_N = 1 << 16;
+	// kernels with at most SMALL_N (<= 256) vertices are solved by small_kernel, 0 to disable
+	int SMALL_N = 128;
+
+	bool USE_DEPENDENCY_CHECKING = false;
+};
+
+/**
+ * Statistics of one solve, shared by all its solvers and updated by all threads working on it.
+ */
+struct solver_stats
+{
+	std::atomic<long> nBranchings{0};
+	// nodes of the bitset search of small kernels, not counted in nBranchings
+	std::atomic<long> smallBranchings{0};
+	std::atomic<long> defaultBranchings{0};
+	std::atomic<long> defaultPicks{0};
+	std::atomic<long> stratPicks{0};
+	std::atomic<long> nDecomps{0};
+	std::atomic<long> prunes{0};
+	// --check-precision: picks of the model, picks the fp32 model scores higher, fp32 score lost in total
+	std::atomic<long> precisionPicks{0};
+	std::atomic<long> precisionMisses{0};
+	std::atomic<double> precisionLoss{0};
+};
+
+#endif // SOLVER_CONFIG_H
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
 
 #pragma once
 
@@ -24,6 +25,7 @@ private:
     int num_nodes, num_edges;
     string graph_name;
     std::vector<debug_info> infos;
+    std::mutex m; // components may be solved concurrently
 
 public:
 
@@ -34,6 +36,7 @@ public:
     }
 
     void add_info(debug_info info) {
+        std::lock_guard<std::mutex> lk(m);
         infos.push_back(info);
     }
 
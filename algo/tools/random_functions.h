@@ -140,12 +140,13 @@ class random_functions {
                 }
 
         private:
-                static int m_seed;
-                static MersenneTwister m_mt;
+                // one generator per thread, the local search runs in every solver thread
+                static thread_local int m_seed;
+                static thread_local MersenneTwister m_mt;
 };
 
-MersenneTwister random_functions::m_mt;
-int random_functions::m_seed = 0;
+thread_local MersenneTwister random_functions::m_mt;
+thread_local int random_functions::m_seed = 0;
 
 random_functions::random_functions()  {
 }
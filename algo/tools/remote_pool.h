@@ -0,0 +1,303 @@
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <csignal>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+
+#pragma once
+
+/**
+ * Messages between a coordinator and its worker processes, a header of three ints
+ * (type, task, payload length) followed by the payload ints.
+ *
+ * TASK:   bound, seconds, n, m, offsets[n + 1], nbr[m]; the remaining graph of a node,
+ *         the worker looks for a vertex cover smaller than bound
+ * BOUND:  bound; a better bound for the task, sent in both directions
+ * RESULT: cover size, #branchings, #branchings of small kernels, the cover of the n vertices if it
+ *         is smaller than the bound; the counts are 64 bit and take two ints each, see push_long()
+ * QUIT:   no payload
+ */
+struct remote_message {
+    enum type_t { TASK, BOUND, RESULT, QUIT };
+
+    int type;
+    int task;
+    std::vector<int> data;
+};
+
+inline bool write_all(int fd, void const *p, size_t size) {
+    char const *c = static_cast<char const *>(p);
+    while (size > 0) {
+        ssize_t k = write(fd, c, size);
+        if (k <= 0)
+            return false;
+        c += k;
+        size -= k;
+    }
+    return true;
+}
+
+inline bool read_all(int fd, void *p, size_t size) {
+    char *c = static_cast<char *>(p);
+    while (size > 0) {
+        ssize_t k = read(fd, c, size);
+        if (k <= 0)
+            return false;
+        c += k;
+        size -= k;
+    }
+    return true;
+}
+
+// appends a 64 bit count to a payload as two ints, the high half first
+inline void push_long(std::vector<int> &data, long v) {
+    unsigned long long u = static_cast<unsigned long long>(v);
+    data.push_back(static_cast<int>(u >> 32));
+    data.push_back(static_cast<int>(u & 0xffffffffu));
+}
+
+// reads a count written by push_long()
+inline long read_long(int const *p) {
+    return static_cast<long>(static_cast<unsigned long long>(static_cast<unsigned>(p[0])) << 32 | static_cast<unsigned>(p[1]));
+}
+
+inline bool write_message(int fd, remote_message const &msg) {
+    int header[3] = {msg.type, msg.task, static_cast<int>(msg.data.size())};
+    return write_all(fd, header, sizeof(header)) && write_all(fd, msg.data.data(), sizeof(int) * msg.data.size());
+}
+
+inline bool read_message(int fd, remote_message &msg) {
+    int header[3];
+    if (!read_all(fd, header, sizeof(header)))
+        return false;
+    msg.type = header[0];
+    msg.task = header[1];
+    msg.data.resize(header[2]);
+    return read_all(fd, msg.data.data(), sizeof(int) * msg.data.size());
+}
+
+/**
+ * Worker processes of a coordinator. A worker talks over its stdin and stdout, so the same
+ * command can later be started on another host (e.g. through ssh). A task is the remaining graph
+ * of a search node, the node itself (modification log, packings) stays with the coordinator,
+ * which maps the cover found by the worker back. While a task runs, better bounds of the solver
+ * that sent it are passed on to the worker. The cover of a worker goes into the solver's shared
+ * bound once its result arrives; bounds it reports before only keep the pool from sending it
+ * worse ones, since their covers are lost if the worker dies.
+ */
+class remote_pool {
+
+private:
+
+    struct worker {
+        pid_t pid;
+        int in, out; // we write to in and read from out
+        int task = -1;
+        bool alive = true;
+    };
+
+    struct task {
+        int worker;
+        int crt; // the worker's bounds and covers are relative to crt
+        std::shared_ptr<std::atomic<int>> best;
+        int sent;
+        bool done = false;
+        bool failed = false;
+        int opt = 0;
+        long branchings = 0;
+        long smallBranchings = 0;
+        std::vector<int> cover;
+    };
+
+    std::mutex m;
+    std::condition_variable done_cv;
+    std::vector<worker> workers;
+    std::map<int, task> tasks;
+    int nextTask = 0;
+    bool stop = false;
+    std::thread io;
+
+    // worker w died, its task is reported as failed
+    void lost(int w) {
+        workers[w].alive = false;
+        if (workers[w].task >= 0) {
+            task &t = tasks[workers[w].task];
+            t.done = t.failed = true;
+            workers[w].task = -1;
+            done_cv.notify_all();
+        }
+    }
+
+    void receive(int w, remote_message &msg) {
+        auto it = tasks.find(msg.task);
+        if (it == tasks.end() || it->second.done)
+            return;
+        task &t = it->second;
+        if (msg.type == remote_message::BOUND) {
+            t.sent = std::min(t.sent, msg.data[0]);
+        } else if (msg.type == remote_message::RESULT) {
+            t.opt = msg.data[0];
+            t.branchings = read_long(&msg.data[1]);
+            t.smallBranchings = read_long(&msg.data[3]);
+            t.cover.assign(msg.data.begin() + 5, msg.data.end());
+            if (!t.cover.empty()) {
+                int value = t.crt + t.opt;
+                int best = *t.best;
+                while (value < best && !t.best->compare_exchange_weak(best, value))
+                    ;
+            }
+            t.done = true;
+            workers[w].task = -1;
+            done_cv.notify_all();
+        }
+    }
+
+    // reads the results and bounds of the workers and sends them the bounds of the solvers
+    void run() {
+        std::unique_lock<std::mutex> lk(m);
+        while (!stop) {
+            std::vector<pollfd> fds;
+            std::vector<int> ws;
+            for (int w = 0; w < static_cast<int>(workers.size()); w++)
+                if (workers[w].alive) {
+                    fds.push_back({workers[w].out, POLLIN, 0});
+                    ws.push_back(w);
+                }
+            lk.unlock();
+            poll(fds.data(), fds.size(), 50);
+            std::vector<std::pair<int, remote_message>> msgs;
+            for (unsigned int i = 0; i < fds.size(); i++)
+                if (fds[i].revents != 0) {
+                    remote_message msg;
+                    if (!read_message(fds[i].fd, msg))
+                        msg.type = -1;
+                    msgs.emplace_back(ws[i], std::move(msg));
+                }
+            lk.lock();
+            for (auto &wm : msgs) {
+                if (wm.second.type < 0)
+                    lost(wm.first);
+                else
+                    receive(wm.first, wm.second);
+            }
+            for (auto &it : tasks) {
+                task &t = it.second;
+                int bound = *t.best - t.crt;
+                if (t.done || bound >= t.sent)
+                    continue;
+                t.sent = bound;
+                if (!write_message(workers[t.worker].in, {remote_message::BOUND, it.first, {bound}}))
+                    lost(t.worker);
+            }
+        }
+    }
+
+public:
+
+    // starts the workers as cmd[0] cmd[1] ...
+    remote_pool(std::vector<std::string> const &cmd, int n) {
+        signal(SIGPIPE, SIG_IGN); // a dead worker shows up as a failed write instead
+        std::vector<char *> argv;
+        for (std::string const &s : cmd)
+            argv.push_back(const_cast<char *>(s.c_str()));
+        argv.push_back(nullptr);
+        for (int i = 0; i < n; i++) {
+            int to[2], from[2];
+            if (pipe(to) != 0 || pipe(from) != 0) {
+                perror("pipe");
+                exit(1);
+            }
+            pid_t pid = fork();
+            if (pid == 0) {
+                dup2(to[0], 0);
+                dup2(from[1], 1);
+                close(to[0]);
+                close(to[1]);
+                close(from[0]);
+                close(from[1]);
+                for (worker const &w : workers) {
+                    close(w.in);
+                    close(w.out);
+                }
+                execv(argv[0], argv.data());
+                perror("execv");
+                _exit(1);
+            }
+            close(to[0]);
+            close(from[1]);
+            worker w;
+            w.pid = pid;
+            w.in = to[1];
+            w.out = from[0];
+            workers.push_back(w);
+        }
+        io = std::thread(&remote_pool::run, this);
+    }
+
+    ~remote_pool() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+        }
+        io.join();
+        for (worker &w : workers) {
+            if (w.alive)
+                write_message(w.in, {remote_message::QUIT, -1, {}});
+            close(w.in);
+            close(w.out);
+            waitpid(w.pid, nullptr, 0);
+        }
+    }
+
+    // true if a worker has nothing to do
+    bool idle() {
+        std::lock_guard<std::mutex> lk(m);
+        for (worker const &w : workers)
+            if (w.alive && w.task < 0)
+                return true;
+        return false;
+    }
+
+    // sends a TASK payload to an idle worker, best is the bound of the sending solver, -1 if all workers are busy
+    int submit(int crt, std::shared_ptr<std::atomic<int>> best, std::vector<int> &&data) {
+        std::lock_guard<std::mutex> lk(m);
+        for (int w = 0; w < static_cast<int>(workers.size()); w++)
+            if (workers[w].alive && workers[w].task < 0) {
+                int id = nextTask++;
+                task &t = tasks[id];
+                t.worker = w;
+                t.crt = crt;
+                t.best = best;
+                t.sent = data[0];
+                workers[w].task = id;
+                if (!write_message(workers[w].in, {remote_message::TASK, id, std::move(data)}))
+                    lost(w);
+                return id;
+            }
+        return -1;
+    }
+
+    // waits for a task, false if its worker died; otherwise cover is empty or a cover smaller than the bound
+    bool wait(int id, int &opt, long &branchings, long &smallBranchings, std::vector<int> &cover) {
+        std::unique_lock<std::mutex> lk(m);
+        done_cv.wait(lk, [this, id]() { return tasks[id].done; });
+        task &t = tasks[id];
+        bool ok = !t.failed;
+        opt = t.opt;
+        branchings = t.branchings;
+        smallBranchings = t.smallBranchings;
+        cover.swap(t.cover);
+        tasks.erase(id);
+        return ok;
+    }
+};
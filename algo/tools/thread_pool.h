@@ -0,0 +1,103 @@
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+#pragma once
+
+/**
+ * Fixed set of worker threads shared by all solver instances.
+ * A thread that waits for its own tasks (help_while) runs queued tasks in the meantime,
+ * so tasks can submit and wait for further tasks without deadlocking the pool.
+ */
+class thread_pool {
+
+private:
+
+    std::mutex m;
+    std::condition_variable work_cv; // new tasks or shutdown
+    std::condition_variable done_cv; // a task finished or was queued
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    bool stop = false;
+    std::atomic<int> queued{0}; // tasks.size(), readable without the lock
+
+    void work() {
+        std::unique_lock<std::mutex> lk(m);
+        for (;;) {
+            work_cv.wait(lk, [this]() { return stop || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+            run_front(lk);
+        }
+    }
+
+    // runs the first task without holding the lock, lk is locked again afterwards
+    void run_front(std::unique_lock<std::mutex> &lk) {
+        std::function<void()> f = std::move(tasks.front());
+        tasks.pop_front();
+        queued--;
+        lk.unlock();
+        f();
+        lk.lock();
+        done_cv.notify_all();
+    }
+
+public:
+
+    // the calling thread counts as one of the threads
+    thread_pool(int threads) {
+        for (int i = 1; i < threads; i++)
+            workers.emplace_back(&thread_pool::work, this);
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+        }
+        work_cv.notify_all();
+        for (auto &w : workers)
+            w.join();
+    }
+
+    int size() const {
+        return workers.size() + 1;
+    }
+
+    // true while fewer tasks are queued than there are threads to take them
+    bool wants_work() const {
+        return queued < size();
+    }
+
+    void submit(std::function<void()> f) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            tasks.push_back(std::move(f));
+            queued++;
+        }
+        work_cv.notify_one();
+        done_cv.notify_all();
+    }
+
+    // runs queued tasks until busy() returns false, busy() is evaluated under the pool lock
+    template <typename F>
+    void help_while(F busy) {
+        std::unique_lock<std::mutex> lk(m);
+        while (busy()) {
+            if (!tasks.empty())
+                run_front(lk);
+            else
+                done_cv.wait(lk);
+        }
+    }
+
+    // pool used by the solvers, created with the given number of threads on the first call
+    static thread_pool &shared(int threads) {
+        static thread_pool pool(threads);
+        return pool;
+    }
+};
@@ -0,0 +1,43 @@
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include "IO/read_graph.h"
+#include "IO/binary_graph.h"
+
+// Writes a binary CSR sidecar (<graph>.csr) next to every text graph given,
+// directories are converted file by file, skipping sidecars and partly written ones (.tmp).
+void convert(std::string path)
+{
+    std::vector<std::vector<int>> adj = readGraphFromFile(path);
+    std::string out = path + CSR_SUFFIX;
+    if (!writeBinaryGraph(adj, out))
+    {
+        std::cout << "Failed to write " << out << std::endl;
+        exit(1);
+    }
+    std::cout << path << " -> " << out << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <graph file or directory>..." << std::endl;
+        exit(-1);
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::filesystem::is_directory(argv[i]))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(argv[i]))
+                if (!entry.is_directory() && entry.path().extension() != CSR_SUFFIX && entry.path().extension() != CSR_TMP_SUFFIX)
+                    convert(entry.path());
+        }
+        else
+            convert(argv[i]);
+    }
+
+    return 0;
+}
@@ -1,282 +1,179 @@
 #include "gcn.h"
+#include "gcn_kernels.h"
+#include "../algo/tools/thread_pool.h"
 
-#include <immintrin.h>
 #include <stdalign.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <atomic>
+#include <algorithm>
 
-#pragma GCC target("avx2")
-
-// Specialized implementation for compile-time constant input dim
-
-void gcn_layer_input(int N, int *V, int *E,
-                     const float *__restrict__ W,
-                     const float *__restrict__ B,
-                     const float *__restrict__ x, float *__restrict__ y,
-                     const float *__restrict__ scale)
+// Calls f(begin, end) for row blocks covering [0, N). Blocks start at multiples of 8, so the
+// kernels see the same 4 row groups as in one serial pass and the results are bit-identical.
+template <typename F>
+static void for_row_blocks(thread_pool *pool, int N, F f)
 {
-
-    float _y[4][INPUT];
-
-    for (int i = 0; i < N; i += 4)
+    if (pool == NULL || N < GCN_PARALLEL_N)
     {
-        // Compute message passing results
-        for (int j = 0; j < 4; j++)
-        {
-            int u = i + j;
-            if (u >= N)
-                break;
-
-            const float *_xu = x + u * INPUT; // Input for u
-            for (int k = 0; k < INPUT; k++)
-                _y[j][k] = scale[u] * _xu[k];
-
-            // Neighbors
-            for (int k = V[u]; k < V[u + 1]; k++)
-            {
-                int v = E[k];
-                const float *_xv = x + v * INPUT; // Input for v
-                for (int l = 0; l < INPUT; l++)
-                    _y[j][l] += scale[v] * _xv[l];
-            }
-
-            for (int k = 0; k < INPUT; k++)
-                _y[j][k] *= scale[u];
-        }
-
-        // Compute dense layer part
-        for (int j = 0; j < DIM; j += 16)
-        {
-
-            __m256 c[4][2];
-            for (int k = 0; k < 4; k++)
-            {
-                c[k][0] = _mm256_load_ps(&B[j]);
-                c[k][1] = _mm256_load_ps(&B[j + 8]);
-            }
-
-            __m256 b0, b1, a;
-
-            for (int k = 0; k < INPUT; k++)
-            {
-                b0 = _mm256_load_ps(&W[k * DIM + j]);
-                b1 = _mm256_load_ps(&W[k * DIM + j + 8]);
-
-                for (int l = 0; l < 4; l++)
-                {
-                    a = _mm256_broadcast_ss(&_y[l][k]);
-                    c[l][0] = _mm256_fmadd_ps(a, b0, c[l][0]);
-                    c[l][1] = _mm256_fmadd_ps(a, b1, c[l][1]);
-                }
-            }
-
-            __m256 zero = _mm256_setzero_ps();
-            for (int k = 0; k < 4; k++)
-            {
-                // ReLU before storing results
-                c[k][0] = _mm256_max_ps(c[k][0], zero);
-                c[k][1] = _mm256_max_ps(c[k][1], zero);
-
-                _mm256_store_ps(&y[(i + k) * DIM + j], c[k][0]);
-                _mm256_store_ps(&y[(i + k) * DIM + j + 8], c[k][1]);
-            }
-        }
+        f(0, N);
+        return;
+    }
+    int tasks = pool->size() * 4;
+    int block = ((N + tasks - 1) / tasks + 7) & ~7;
+    std::atomic<int> pending(0);
+    for (int b = block; b < N; b += block)
+    {
+        pending++;
+        pool->submit([&f, &pending, b, block, N]() {
+            f(b, std::min(N, b + block));
+            pending--;
+        });
     }
+    f(0, std::min(N, block));
+    pool->help_while([&pending]() { return pending > 0; });
 }
 
-// Specialized implementation for compile-time constant hidden dim
-
-void gcn_layer_hidden(int N, int *V, int *E,
-                      const float *__restrict__ W,
-                      const float *__restrict__ B,
-                      const float *__restrict__ x, float *__restrict__ y,
-                      const float *__restrict__ scale)
+namespace
 {
-
-    alignas(32) float _y[4][DIM];
-    const int dim_v = DIM / 8;
-
-    for (int i = 0; i < N; i += 4)
+    // baseline code for CPUs without AVX2 and FMA
+    struct scalar_ops
     {
-        // Compute message passing results
-        for (int j = 0; j < 4; j++)
-        {
-            int u = i + j;
-            if (u >= N)
-                break;
-
-            __m256 yv[dim_v];                           // Output for u
-            __m256 su = _mm256_broadcast_ss(scale + u); // Scale for u
-            const float *_xu = x + u * DIM;             // Input for u
-            for (int k = 0; k < dim_v; k++)
-            {
-                __m256 xv = _mm256_load_ps(_xu + k * 8);
-                yv[k] = _mm256_mul_ps(su, xv);
-            }
+        typedef float vec;
+        typedef int32_t veci;
+        static const int W = 1;
+        static const int R = 2, A = 32;
 
-            // Neighbors
-            for (int k = V[u]; k < V[u + 1]; k++)
-            {
-                int v = E[k];
-                __m256 sv = _mm256_broadcast_ss(scale + v); // Scale for v
-                const float *_xv = x + v * DIM;             // Input for v
-                for (int l = 0; l < dim_v; l++)
-                {
-                    __m256 xv = _mm256_load_ps(&_xv[l * 8]);
-                    yv[l] = _mm256_fmadd_ps(sv, xv, yv[l]);
-                }
-            }
-
-            for (int k = 0; k < dim_v; k++)
-            {
-                yv[k] = _mm256_mul_ps(yv[k], su);
-                _mm256_store_ps(&_y[j][k * 8], yv[k]);
-            }
-        }
+        static vec load(const float *p) { return *p; }
+        static void store(float *p, vec a) { *p = a; }
 
-        // Compute dense layer part
-        for (int j = 0; j < DIM; j += 16)
+        static vec load(const gcn_bf16 *p)
         {
+            uint32_t i = (uint32_t)p->bits << 16;
+            float a;
+            memcpy(&a, &i, sizeof(a));
+            return a;
+        }
 
-            __m256 c[4][2];
-            for (int k = 0; k < 4; k++)
-            {
-                c[k][0] = _mm256_load_ps(&B[j]);
-                c[k][1] = _mm256_load_ps(&B[j + 8]);
-            }
+        static void store(gcn_bf16 *p, vec a) { p->bits = gcn_to_bf16(a); }
+        static vec load(const uint8_t *p) { return *p; }
+        static void store(uint8_t *p, vec a) { *p = std::max(0L, std::min(127L, lrintf(a))); }
 
-            __m256 b0, b1, a;
+        static vec set1(float a) { return a; }
+        static vec zero() { return 0.0f; }
+        static vec mul(vec a, vec b) { return a * b; }
+        static vec fmadd(vec a, vec b, vec c) { return a * b + c; }
+        static vec max(vec a, vec b) { return a > b ? a : b; }
+        static float sum(vec a) { return a; }
 
-            for (int k = 0; k < DIM; k++)
-            {
-                b0 = _mm256_load_ps(&W[k * DIM + j]);
-                b1 = _mm256_load_ps(&W[k * DIM + j + 8]);
+        static veci loadi(const int8_t *p)
+        {
+            veci a;
+            memcpy(&a, p, sizeof(a));
+            return a;
+        }
 
-                for (int l = 0; l < 4; l++)
-                {
-                    a = _mm256_broadcast_ss(&_y[l][k]);
-                    c[l][0] = _mm256_fmadd_ps(a, b0, c[l][0]);
-                    c[l][1] = _mm256_fmadd_ps(a, b1, c[l][1]);
-                }
-            }
+        static veci set1i(int32_t a) { return a; }
+        static veci zeroi() { return 0; }
+        static vec cvt(veci a) { return a; }
 
-            __m256 zero = _mm256_setzero_ps();
+        static veci dot4(veci c, veci a, veci b)
+        {
+            uint8_t ua[4];
+            int8_t sb[4];
+            memcpy(ua, &a, 4);
+            memcpy(sb, &b, 4);
             for (int k = 0; k < 4; k++)
-            {
-                // ReLU before storing results
-                c[k][0] = _mm256_max_ps(c[k][0], zero);
-                c[k][1] = _mm256_max_ps(c[k][1], zero);
-
-                _mm256_store_ps(&y[(i + k) * DIM + j], c[k][0]);
-                _mm256_store_ps(&y[(i + k) * DIM + j + 8], c[k][1]);
-            }
+                c += ua[k] * sb[k];
+            return c;
         }
-    }
+    };
 }
 
-// Specialized implementation for compile-time constant output dim = 1
+gcn_kernels gcn_kernels_scalar(int input, int dim, int precision)
+{
+    return gcn_make_kernels<scalar_ops>(input, dim, precision);
+}
 
-void gcn_layer_output(int N, int *V, int *E,
-                      const float *__restrict__ W,
-                      const float *__restrict__ B,
-                      const float *__restrict__ x, float *__restrict__ y,
-                      const float *__restrict__ scale)
+// widest first
+static const struct
 {
+    const char *name;
+    gcn_kernels (*get)(int input, int dim, int precision);
+} isas[] = {{"avx512vnni", gcn_kernels_avx512_vnni},
+            {"avx512", gcn_kernels_avx512},
+            {"avx2", gcn_kernels_avx2},
+            {"scalar", gcn_kernels_scalar}};
+
+// the widest kernels the CPU supports, so one binary runs everywhere
+static int best_isa()
+{
+    __builtin_cpu_init();
+    bool avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                  __builtin_cpu_supports("fma");
+    if (avx512 && __builtin_cpu_supports("avx512vnni"))
+        return 0;
+    if (avx512)
+        return 1;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return 2;
+    return 3;
+}
 
-    alignas(32) float _y[DIM];
-    const int dim_v = DIM / 8;
+static int isa = best_isa();
 
-    alignas(32) float _r[8];
+const char *gcn_kernels_name()
+{
+    return isas[isa].name;
+}
 
-    for (int i = 0; i < N; i += 8)
-    {
-        // Compute message passing results
-        for (int j = 0; j < 8; j++)
+bool gcn_use_kernels(const char *name)
+{
+    for (int i = best_isa(); i < 4; i++)
+        if (strcmp(isas[i].name, name) == 0)
         {
-            int u = i + j;
-            if (u >= N)
-                break;
-
-            __m256 yv[dim_v];                           // Output for u
-            __m256 su = _mm256_broadcast_ss(scale + u); // Scale for u
-            const float *_xu = x + u * DIM;             // Input for u
-            for (int k = 0; k < dim_v; k++)
-            {
-                __m256 xv = _mm256_load_ps(_xu + k * 8);
-                yv[k] = _mm256_mul_ps(su, xv);
-            }
-
-            // Neighbors
-            for (int k = V[u]; k < V[u + 1]; k++)
-            {
-                int v = E[k];
-                __m256 sv = _mm256_broadcast_ss(scale + v); // Scale for u
-                const float *_xv = x + v * DIM;             // Input for v
-                for (int l = 0; l < dim_v; l++)
-                {
-                    __m256 xv = _mm256_load_ps(&_xv[l * 8]);
-                    yv[l] = _mm256_fmadd_ps(sv, xv, yv[l]);
-                }
-            }
-
-            for (int k = 0; k < dim_v; k++)
-            {
-                yv[k] = _mm256_mul_ps(yv[k], su);
-                _mm256_store_ps(&_y[k * 8], yv[k]);
-            }
-
-            // Compute dense layer part
-            __m256 c = _mm256_setzero_ps();
-            for (int k = 0; k < DIM; k += 8)
-            {
-                __m256 a = _mm256_load_ps(&_y[k]);
-                __m256 b = _mm256_load_ps(&W[k]);
-                c = _mm256_fmadd_ps(a, b, c);
-            }
-            __m128 l = _mm256_extractf128_ps(c, 0);
-            __m128 h = _mm256_extractf128_ps(c, 1);
-            l = _mm_add_ps(l, h);
-            l = _mm_hadd_ps(l, l);
-            l = _mm_hadd_ps(l, l);
-
-            _r[j] = _mm_cvtss_f32(l) + B[0];
+            isa = i;
+            return true;
         }
-
-        __m256 r = _mm256_load_ps(_r);
-        _mm256_store_ps(y + i, r);
-    }
+    return false;
 }
 
-gcn gcn_init(int hidden_layers)
+gcn gcn_init(int hidden_layers, int input, int dim)
 {
     gcn m = {.hidden_layers = hidden_layers,
+             .input = input,
+             .dim = dim,
              .N = 0,
+             .precision = GCN_FP32,
              .params = NULL,
              .W = NULL,
-             .B = NULL};
+             .B = NULL,
+             .qW = NULL,
+             .qs = NULL};
 
-    m.N = DIM * 2 + hidden_layers * (DIM * DIM + DIM) + DIM * 2;
-    m.params = (float *)aligned_alloc(32, sizeof(float) * m.N);
+    // the output layer has a single bias, but keeps dim floats for alignment
+    m.N = (input + 1) * dim + hidden_layers * (dim * dim + dim) + dim * 2;
+    m.params = (float *)aligned_alloc(64, sizeof(float) * m.N);
     m.W = (float **)malloc(sizeof(float *) * (hidden_layers + 2));
     m.B = (float **)malloc(sizeof(float *) * (hidden_layers + 2));
 
     float *p = m.params;
 
     m.W[0] = p;
-    p += DIM;
+    p += input * dim;
     m.B[0] = p;
-    p += DIM;
+    p += dim;
 
     for (int i = 0; i < hidden_layers; i++)
     {
         m.W[i + 1] = p;
-        p += DIM * DIM;
+        p += dim * dim;
         m.B[i + 1] = p;
-        p += DIM;
+        p += dim;
     }
 
     m.W[hidden_layers + 1] = p;
-    p += DIM;
+    p += dim;
     m.B[hidden_layers + 1] = p;
 
     for (int i = 0; i < m.N; i++)
@@ -285,34 +182,73 @@ gcn gcn_init(int hidden_layers)
     return m;
 }
 
-gcn_data gcn_data_init(int N, int *V, int *E)
+// bytes of an activation
+static size_t activation_size(int precision)
+{
+    return precision == GCN_INT8 ? 1 : precision == GCN_BF16 ? 2 : 4;
+}
+
+// bytes of a row of the activation buffers: input features, hidden activations or a score
+static size_t row_size(gcn m)
+{
+    return std::max({sizeof(float) * m.input, activation_size(m.precision) * m.dim, sizeof(float)});
+}
+
+gcn_data gcn_data_init(gcn m, int N, int *V, int *E, thread_pool *pool)
 {
     gcn_data md = {.N = N, .V = V, .E = E};
+    size_t row = row_size(m);
+    int rows = (N + 7) & ~7;
     md.scale = (float *)malloc(sizeof(float) * N);
-    md.x = (float *)aligned_alloc(32, sizeof(float) * DIM * ((N + 7) & ~7));
-    md.y = (float *)aligned_alloc(32, sizeof(float) * DIM * ((N + 7) & ~7));
+    md.x = (float *)aligned_alloc(64, row * rows);
+    md.y = (float *)aligned_alloc(64, row * rows);
+    md.xs = md.ys = NULL;
+    if (m.precision == GCN_INT8)
+    {
+        md.xs = (float *)malloc(sizeof(float) * rows);
+        md.ys = (float *)malloc(sizeof(float) * rows);
+    }
+    md.pool = pool;
+
+    // first touch by the threads that evaluate the blocks, so the pages are spread over their nodes
+    if (pool != NULL)
+        for_row_blocks(pool, rows, [&md, row](int b, int e) {
+            memset((char *)md.x + b * row, 0, row * (e - b));
+            memset((char *)md.y + b * row, 0, row * (e - b));
+        });
     return md;
 }
 
 void gcn_store(FILE *f, gcn m)
 {
-    fprintf(f, "%d %d %d\n", m.hidden_layers, INPUT, DIM);
+    fprintf(f, "%d %d %d\n", m.hidden_layers, m.input, m.dim);
     for (int i = 0; i < m.N; i++)
         fprintf(f, "%.10f ", m.params[i]);
 
     fprintf(f, "\n");
+
+    // optional: the column scales of the int8 weights of the hidden layers
+    if (m.qs != NULL)
+    {
+        fprintf(f, "int8\n");
+        for (int i = 0; i < m.hidden_layers; i++)
+            for (int j = 0; j < m.dim; j++)
+                fprintf(f, "%.10g ", m.qs[i][j]);
+
+        fprintf(f, "\n");
+    }
 }
 
 gcn gcn_parse(FILE *f)
 {
     int layers, in, dim;
     int t = fscanf(f, "%d %d %d\n", &layers, &in, &dim);
-    if (t != 3 || in != INPUT || dim != DIM)
+    if (t != 3 || gcn_kernels_scalar(in, dim, GCN_FP32).input == NULL)
     {
-        fprintf(stderr, "Model incompatible with build\n");
+        fprintf(stderr, "Model shape not supported (input dims: 1, hidden dims: 16, 32, 64, 128)\n");
         exit(1);
     }
-    gcn m = gcn_init(layers);
+    gcn m = gcn_init(layers, in, dim);
     for (int i = 0; i < m.N; i++)
     {
         t = fscanf(f, "%f ", &m.params[i]);
@@ -322,59 +258,203 @@ gcn gcn_parse(FILE *f)
             exit(1);
         }
     }
+    char tag[8];
+    if (fscanf(f, "%7s ", tag) == 1 && strcmp(tag, "int8") == 0)
+    {
+        m.qs = (float **)malloc(sizeof(float *) * layers);
+        for (int i = 0; i < layers; i++)
+        {
+            m.qs[i] = (float *)aligned_alloc(64, sizeof(float) * dim);
+            for (int j = 0; j < dim; j++)
+                if (fscanf(f, "%f ", &m.qs[i][j]) != 1)
+                {
+                    fprintf(stderr, "Wrong number of int8 scales\n");
+                    exit(1);
+                }
+        }
+    }
     return m;
 }
 
 void gcn_free(gcn m)
 {
+    for (int i = 0; i < m.hidden_layers; i++)
+    {
+        if (m.qW != NULL)
+            free(m.qW[i]);
+        if (m.qs != NULL)
+            free(m.qs[i]);
+    }
+    free(m.qW);
+    free(m.qs);
     free(m.params);
     free(m.W);
     free(m.B);
 }
 
+gcn gcn_with_precision(gcn m, int precision)
+{
+    gcn q = gcn_init(m.hidden_layers, m.input, m.dim);
+    q.precision = precision;
+    memcpy(q.params, m.params, sizeof(float) * m.N);
+    int dim = m.dim;
+
+    if (precision == GCN_BF16)
+        for (int i = 0; i < q.N; i++)
+        {
+            gcn_bf16 b = {gcn_to_bf16(q.params[i])};
+            q.params[i] = scalar_ops::load(&b);
+        }
+
+    if (m.qs != NULL || precision == GCN_INT8)
+    {
+        q.qs = (float **)malloc(sizeof(float *) * m.hidden_layers);
+        for (int i = 0; i < m.hidden_layers; i++)
+        {
+            q.qs[i] = (float *)aligned_alloc(64, sizeof(float) * dim);
+            for (int j = 0; j < dim; j++)
+            {
+                // the largest weight of a column becomes 127 unless the model file has the scales
+                float a = 0.0f;
+                for (int r = 0; r < dim; r++)
+                    a = std::max(a, fabsf(m.W[i + 1][r * dim + j]));
+                q.qs[i][j] = m.qs != NULL ? m.qs[i][j] : a / 127.0f;
+            }
+        }
+    }
+
+    if (precision == GCN_INT8)
+    {
+        q.qW = (int8_t **)malloc(sizeof(int8_t *) * m.hidden_layers);
+        for (int i = 0; i < m.hidden_layers; i++)
+        {
+            q.qW[i] = (int8_t *)aligned_alloc(64, dim * dim);
+            for (int r = 0; r < dim; r++)
+                for (int j = 0; j < dim; j++)
+                {
+                    float s = q.qs[i][j];
+                    long w = s > 0.0f ? lrintf(m.W[i + 1][r * dim + j] / s) : 0;
+                    q.qW[i][(r / 4) * dim * 4 + j * 4 + r % 4] = std::max(-127L, std::min(127L, w));
+                }
+        }
+    }
+    return q;
+}
+
 void gcn_data_free(gcn_data md)
 {
     free(md.scale);
     free(md.x);
     free(md.y);
+    free(md.xs);
+    free(md.ys);
 }
 
-void swap(float **a, float **b)
+// weights of layer k, 0 = input layer, hidden_layers + 1 = output layer
+static gcn_weights weights(gcn m, int k)
 {
-    float *t = *a;
-    *a = *b;
-    *b = t;
+    bool hidden = k > 0 && k <= m.hidden_layers;
+    return {m.W[k], m.B[k], hidden && m.qW != NULL ? m.qW[k - 1] : NULL, hidden && m.qs != NULL ? m.qs[k - 1] : NULL};
 }
 
 void gcn_eval(gcn m, gcn_data md)
 {
     int N = md.N;
-    int *V = md.V, *E = md.E;
-    float *x = md.x, *y = md.y, *scale = md.scale;
+    int *V = md.V;
+    csr_lists g = {md.V, md.E};
+    gcn_rows x = {md.x, md.xs}, y = {md.y, md.ys};
+    float *scale = md.scale;
+    gcn_kernels kernels = isas[isa].get(m.input, m.dim, m.precision);
 
     int l = m.hidden_layers;
 
-    for (int i = 0; i < N; i++)
-        scale[i] = 1.0f / sqrtf((V[i + 1] - V[i]) + 1.0f);
+    for_row_blocks(md.pool, N, [&](int b, int e) {
+        for (int i = b; i < e; i++)
+            scale[i] = gcn_scale(V[i + 1] - V[i]);
 
-    for (int i = 0; i < N; i++)
-        x[i] = 1.0f;
+        for (int i = b * m.input; i < e * m.input; i++)
+            md.x[i] = 1.0f;
+    });
 
-    gcn_layer_input(N, V, E, m.W[0], m.B[0], x, y, scale);
-    swap(&x, &y);
+    for_row_blocks(md.pool, N, [&](int b, int e) {
+        kernels.input(b, e, NULL, g, weights(m, 0), x, y, scale);
+    });
+    std::swap(x, y);
 
     for (int i = 0; i < l; i++)
     {
-        gcn_layer_hidden(N, V, E, m.W[i + 1], m.B[i + 1], x, y, scale);
-        swap(&x, &y);
+        for_row_blocks(md.pool, N, [&](int b, int e) {
+            kernels.hidden(b, e, NULL, g, weights(m, i + 1), x, y, scale);
+        });
+        std::swap(x, y);
     }
 
-    gcn_layer_output(N, V, E, m.W[l + 1], m.B[l + 1], x, y, scale);
-    swap(&x, &y);
+    for_row_blocks(md.pool, N, [&](int b, int e) {
+        kernels.output(b, e, NULL, g, weights(m, l + 1), x, y, scale);
+    });
+    std::swap(x, y);
 
-    if (!(l & 1))
+    if (x.a != md.y)
     {
         for (int i = 0; i < N; i++)
-            y[i] = x[i];
+            md.y[i] = ((float *)x.a)[i];
     }
-}
\ No newline at end of file
+}
+
+gcn_cache gcn_cache_init(gcn m, int N)
+{
+    gcn_cache c = {.N = N, .scale = NULL, .in = NULL, .h = NULL, .hs = NULL, .out = NULL};
+    int rows = (N + 7) & ~7;
+    size_t row = activation_size(m.precision) * m.dim;
+    c.scale = (float *)calloc(N, sizeof(float));
+    c.in = (float *)aligned_alloc(32, sizeof(float) * m.input * rows);
+    for (int i = 0; i < m.input * rows; i++)
+        c.in[i] = 1.0f;
+    c.h = (float **)malloc(sizeof(float *) * (m.hidden_layers + 1));
+    c.hs = (float **)malloc(sizeof(float *) * (m.hidden_layers + 1));
+    for (int i = 0; i <= m.hidden_layers; i++)
+    {
+        // rows that are never evaluated are still read with scale 0, so they must be finite
+        c.h[i] = (float *)aligned_alloc(64, row * rows);
+        memset(c.h[i], 0, row * rows);
+        c.hs[i] = m.precision == GCN_INT8 ? (float *)calloc(rows, sizeof(float)) : NULL;
+    }
+    c.out = (float *)aligned_alloc(32, sizeof(float) * rows);
+    return c;
+}
+
+void gcn_cache_free(gcn m, gcn_cache c)
+{
+    if (c.h == NULL)
+        return;
+    free(c.scale);
+    free(c.in);
+    for (int i = 0; i <= m.hidden_layers; i++)
+    {
+        free(c.h[i]);
+        free(c.hs[i]);
+    }
+    free(c.h);
+    free(c.hs);
+    free(c.out);
+}
+
+void gcn_eval_rows(gcn m, const dyn_csr &adj, thread_pool *pool, gcn_cache c, int *const *rows, const int *nrows)
+{
+    gcn_kernels kernels = isas[isa].get(m.input, m.dim, m.precision);
+    int l = m.hidden_layers;
+
+    for_row_blocks(pool, nrows[0], [&](int b, int e) {
+        kernels.input_lists(b, e, rows[0], adj, weights(m, 0), {c.in, NULL}, {c.h[0], c.hs[0]}, c.scale);
+    });
+
+    for (int i = 0; i < l; i++)
+        for_row_blocks(pool, nrows[i + 1], [&](int b, int e) {
+            kernels.hidden_lists(b, e, rows[i + 1], adj, weights(m, i + 1), {c.h[i], c.hs[i]}, {c.h[i + 1], c.hs[i + 1]},
+                                 c.scale);
+        });
+
+    for_row_blocks(pool, nrows[l + 1], [&](int b, int e) {
+        kernels.output_lists(b, e, rows[l + 1], adj, weights(m, l + 1), {c.h[l], c.hs[l]}, {c.out, NULL}, c.scale);
+    });
+}
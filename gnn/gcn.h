@@ -1,26 +1,74 @@
 #pragma once
 
 #include <stdio.h>
+#include <stdint.h>
+#include <math.h>
 
-#define INPUT 1
-#define DIM 32
+#include "../algo/data_structures/dyn_csr.h"
 
+// graphs with fewer vertices are evaluated on the calling thread only
+#define GCN_PARALLEL_N 4096
+
+class thread_pool;
+
+/**
+ * Precision of the activations during inference. bf16 keeps the upper half of the floats (weights
+ * are rounded the same way), int8 stores every row as 7-bit values times a scale of the row and
+ * uses int8 weights with a scale per column in the hidden layers. Sums are always done in fp32 or int32.
+ */
+enum gcn_precision
+{
+    GCN_FP32,
+    GCN_BF16,
+    GCN_INT8
+};
+
+/**
+ * Model with input features of size input and hidden layers of width dim, the shapes that
+ * have kernels are listed in gcn_make_kernels.
+ */
 typedef struct
 {
-    int hidden_layers, N;
+    int hidden_layers, input, dim, N;
+    int precision;
     float *params, **W, **B;
+    int8_t **qW; // int8 weights of the hidden layers, 4 rows interleaved: qW[k][(r / 4) * dim * 4 + c * 4 + r % 4]
+    float **qs;  // scales of the columns of qW, read from the model file if it has them
 } gcn;
 
 typedef struct
 {
     int N;
     int *V, *E;
-    float *x, *y, *scale;
+    float *x, *y, *scale; // x, y hold activations in the precision of the model, y the scores after gcn_eval
+    float *xs, *ys;       // row scales of int8 activations
+    thread_pool *pool;    // the layers are split into row blocks on this pool, NULL for serial evaluation
 } gcn_data;
 
-gcn gcn_init(int hidden_layers);
+/**
+ * Activations of every layer for a graph whose row ids stay the same between evaluations,
+ * so that only the rows around changes of the graph have to be evaluated again.
+ * The graph is read from a dyn_csr whose lists may still name removed vertices; their
+ * scale is 0, so they add nothing and the results equal those without them.
+ */
+typedef struct
+{
+    int N;
+    float *scale, *in;
+    float **h;  // h[k]: output of layer k, k = 0, ..., hidden_layers, in the precision of the model
+    float **hs; // row scales of int8 activations
+    float *out; // output of the last layer
+} gcn_cache;
+
+// kernels in use: "avx512vnni", "avx512", "avx2" or "scalar", the widest ones the CPU supports unless changed
+const char *gcn_kernels_name();
 
-gcn_data gcn_data_init(int N, int *V, int *E);
+// uses the given kernels instead, false if they are unknown or not supported by the CPU
+bool gcn_use_kernels(const char *name);
+
+gcn gcn_init(int hidden_layers, int input, int dim);
+
+gcn_data gcn_data_init(gcn m, int N, int *V, int *E, thread_pool *pool = NULL);
 
 void gcn_store(FILE *f, gcn m);
 
@@ -28,6 +76,21 @@ gcn gcn_parse(FILE *f);
 
 void gcn_free(gcn m);
 
+// copy of m with the given precision
+gcn gcn_with_precision(gcn m, int precision);
+
 void gcn_data_free(gcn_data md);
 
 void gcn_eval(gcn m, gcn_data md);
+
+gcn_cache gcn_cache_init(gcn m, int N);
+
+void gcn_cache_free(gcn m, gcn_cache c);
+
+// scale of a vertex with deg neighbours
+inline float gcn_scale(int deg) { return 1.0f / sqrtf(deg + 1.0f); }
+
+// evaluates layer k (0 = input layer, hidden_layers + 1 = output layer) on the rows rows[k][0, nrows[k]),
+// the other rows of c must hold the activations of the graph adj. c.scale must hold gcn_scale(degree)
+// for the vertices of the graph and 0 for removed ones.
+void gcn_eval_rows(gcn m, const dyn_csr &adj, thread_pool *pool, gcn_cache c, int *const *rows, const int *nrows);
@@ -0,0 +1,81 @@
+#include "gcn_kernels.h"
+
+#include <immintrin.h>
+
+// built with -mavx2 -mfma, only called on CPUs that have both
+
+namespace
+{
+    struct avx2_ops
+    {
+        typedef __m256 vec;
+        typedef __m256i veci;
+        static const int W = 8;
+        static const int R = 2, A = 8;
+
+        static vec load(const float *p) { return _mm256_load_ps(p); }
+        static void store(float *p, vec a) { _mm256_store_ps(p, a); }
+
+        static vec load(const gcn_bf16 *p)
+        {
+            __m256i i = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p));
+            return _mm256_castsi256_ps(_mm256_slli_epi32(i, 16));
+        }
+
+        static void store(gcn_bf16 *p, vec a)
+        {
+            __m256i i = _mm256_castps_si256(a);
+            __m256i odd = _mm256_and_si256(_mm256_srli_epi32(i, 16), _mm256_set1_epi32(1));
+            i = _mm256_srli_epi32(_mm256_add_epi32(i, _mm256_add_epi32(odd, _mm256_set1_epi32(0x7fff))), 16);
+            i = _mm256_permute4x64_epi64(_mm256_packus_epi32(i, i), 0x08);
+            _mm_storeu_si128((__m128i *)p, _mm256_castsi256_si128(i));
+        }
+
+        static vec load(const uint8_t *p)
+        {
+            return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)p)));
+        }
+
+        static void store(uint8_t *p, vec a)
+        {
+            __m256i i = _mm256_cvtps_epi32(a);
+            i = _mm256_max_epi32(_mm256_min_epi32(i, _mm256_set1_epi32(127)), _mm256_setzero_si256());
+            i = _mm256_packus_epi16(_mm256_packus_epi32(i, i), i);
+            i = _mm256_permutevar8x32_epi32(i, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+            _mm_storel_epi64((__m128i *)p, _mm256_castsi256_si128(i));
+        }
+
+        static vec set1(float a) { return _mm256_set1_ps(a); }
+        static vec zero() { return _mm256_setzero_ps(); }
+        static vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm256_fmadd_ps(a, b, c); }
+        static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+
+        static float sum(vec a)
+        {
+            __m128 l = _mm256_extractf128_ps(a, 0);
+            __m128 h = _mm256_extractf128_ps(a, 1);
+            l = _mm_add_ps(l, h);
+            l = _mm_hadd_ps(l, l);
+            l = _mm_hadd_ps(l, l);
+            return _mm_cvtss_f32(l);
+        }
+
+        static veci loadi(const int8_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+        static veci set1i(int32_t a) { return _mm256_set1_epi32(a); }
+        static veci zeroi() { return _mm256_setzero_si256(); }
+        static vec cvt(veci a) { return _mm256_cvtepi32_ps(a); }
+
+        // the 7-bit activations keep the pair sums of maddubs below the int16 limit
+        static veci dot4(veci c, veci a, veci b)
+        {
+            __m256i p = _mm256_madd_epi16(_mm256_maddubs_epi16(a, b), _mm256_set1_epi16(1));
+            return _mm256_add_epi32(c, p);
+        }
+    };
+}
+
+gcn_kernels gcn_kernels_avx2(int input, int dim, int precision)
+{
+    return gcn_make_kernels<avx2_ops>(input, dim, precision);
+}
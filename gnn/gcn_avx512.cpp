@@ -0,0 +1,78 @@
+#include "gcn_kernels.h"
+
+#include <immintrin.h>
+
+// built with -mavx512f -mavx512bw -mfma, only called on CPUs that have them. DIM = 32 is two registers.
+// gcn_avx512_vnni.cpp builds this file again with -mavx512vnni for the int8 dot products.
+
+namespace
+{
+    struct avx512_ops
+    {
+        typedef __m512 vec;
+        typedef __m512i veci;
+        static const int W = 16;
+        static const int R = 4, A = 8;
+
+        static vec load(const float *p) { return _mm512_load_ps(p); }
+        static void store(float *p, vec a) { _mm512_store_ps(p, a); }
+
+        static vec load(const gcn_bf16 *p)
+        {
+            __m512i i = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)p));
+            return _mm512_castsi512_ps(_mm512_slli_epi32(i, 16));
+        }
+
+        static void store(gcn_bf16 *p, vec a)
+        {
+            __m512i i = _mm512_castps_si512(a);
+            __m512i odd = _mm512_and_si512(_mm512_srli_epi32(i, 16), _mm512_set1_epi32(1));
+            i = _mm512_srli_epi32(_mm512_add_epi32(i, _mm512_add_epi32(odd, _mm512_set1_epi32(0x7fff))), 16);
+            _mm256_storeu_si256((__m256i *)p, _mm512_cvtepi32_epi16(i));
+        }
+
+        static vec load(const uint8_t *p)
+        {
+            return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)p)));
+        }
+
+        static void store(uint8_t *p, vec a)
+        {
+            __m512i i = _mm512_cvtps_epi32(a);
+            i = _mm512_max_epi32(_mm512_min_epi32(i, _mm512_set1_epi32(127)), _mm512_setzero_si512());
+            _mm_storeu_si128((__m128i *)p, _mm512_cvtepi32_epi8(i));
+        }
+
+        static vec set1(float a) { return _mm512_set1_ps(a); }
+        static vec zero() { return _mm512_setzero_ps(); }
+        static vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm512_fmadd_ps(a, b, c); }
+        static vec max(vec a, vec b) { return _mm512_max_ps(a, b); }
+        static float sum(vec a) { return _mm512_reduce_add_ps(a); }
+
+        static veci loadi(const int8_t *p) { return _mm512_loadu_si512(p); }
+        static veci set1i(int32_t a) { return _mm512_set1_epi32(a); }
+        static veci zeroi() { return _mm512_setzero_si512(); }
+        static vec cvt(veci a) { return _mm512_cvtepi32_ps(a); }
+
+        static veci dot4(veci c, veci a, veci b)
+        {
+#ifdef __AVX512VNNI__
+            return _mm512_dpbusd_epi32(c, a, b);
+#else
+            // the 7-bit activations keep the pair sums of maddubs below the int16 limit
+            __m512i p = _mm512_madd_epi16(_mm512_maddubs_epi16(a, b), _mm512_set1_epi16(1));
+            return _mm512_add_epi32(c, p);
+#endif
+        }
+    };
+}
+
+#ifdef __AVX512VNNI__
+gcn_kernels gcn_kernels_avx512_vnni(int input, int dim, int precision)
+#else
+gcn_kernels gcn_kernels_avx512(int input, int dim, int precision)
+#endif
+{
+    return gcn_make_kernels<avx512_ops>(input, dim, precision);
+}
@@ -0,0 +1,2 @@
+// the AVX-512 kernels with VNNI dot products, built with -mavx512f -mavx512bw -mavx512vnni -mfma
+#include "gcn_avx512.cpp"
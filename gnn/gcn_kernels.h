@@ -0,0 +1,384 @@
+#pragma once
+
+#include "gcn.h"
+
+#include <string.h>
+#include <type_traits>
+
+/**
+ * Layer kernels, written once against a vector type V and compiled for every instruction set in
+ * its own file (gcn.cpp: scalar, gcn_avx2.cpp, gcn_avx512.cpp), and for every model shape
+ * (INPUT, DIM) and precision in gcn_make_kernels. V provides
+ *
+ *   vec, W            register type and its number of floats
+ *   R, A              registers for the columns of the dense part and for message passing
+ *   load, store       access to W floats, W bf16 or W 7-bit values (stores round, 7-bit ones clamp)
+ *   set1, zero        broadcast
+ *   mul, fmadd, max   elementwise, fmadd(a, b, c) = a * b + c
+ *   sum               sum of the W floats
+ *   veci, loadi, set1i, zeroi, cvt
+ *                     W int32, loadi reads 4 W int8
+ *   dot4              dot4(c, a, b) adds the dot products of the 4 bytes of a (unsigned) and b (signed) to c
+ *
+ * The ops types of the files live in anonymous namespaces, so the instantiations never mix.
+ */
+
+// upper half of a float
+struct gcn_bf16
+{
+    uint16_t bits;
+};
+
+// rounds to the nearest bf16, ties to even
+inline uint16_t gcn_to_bf16(float a)
+{
+    uint32_t i;
+    memcpy(&i, &a, sizeof(i));
+    return (i + 0x7fff + ((i >> 16) & 1)) >> 16;
+}
+
+// neighbour lists of a CSR graph, indexed like a dyn_csr
+struct csr_lists
+{
+    int *V, *E;
+    dyn_csr::range operator[](int u) const { return {E + V[u], E + V[u + 1]}; }
+};
+
+// weights of a layer, qW and qs only for the hidden layers of int8 models
+struct gcn_weights
+{
+    const float *W, *B;
+    const int8_t *qW;
+    const float *qs;
+};
+
+// activations of a layer, rs holds the row scales of int8 activations
+struct gcn_rows
+{
+    void *a;
+    float *rs;
+};
+
+// evaluates the rows [begin, end), or the rows rows[begin, end) if rows is not NULL,
+// g[u] is the neighbour list of row u
+template <typename G>
+using gcn_layer = void (*)(int begin, int end, const int *rows, const G &g,
+                           const gcn_weights &w, gcn_rows x, gcn_rows y, const float *scale);
+
+struct gcn_kernels
+{
+    gcn_layer<csr_lists> input, hidden, output;
+    gcn_layer<dyn_csr> input_lists, hidden_lists, output_lists;
+};
+
+// kernels for a model shape and precision, all NULL if they are not instantiated
+gcn_kernels gcn_kernels_scalar(int input, int dim, int precision);
+gcn_kernels gcn_kernels_avx2(int input, int dim, int precision);
+gcn_kernels gcn_kernels_avx512(int input, int dim, int precision);
+gcn_kernels gcn_kernels_avx512_vnni(int input, int dim, int precision);
+
+template <int a, int b>
+constexpr int gcn_min() { return a < b ? a : b; }
+
+template <typename T>
+constexpr bool gcn_int8() { return std::is_same<T, uint8_t>::value; }
+
+// stores 4 rows of ReLU outputs as int8 rows, the largest value of a row becomes 127
+template <typename V, int DIM>
+inline void gcn_store_int8(int i, int end, const int *rows, const float (*_o)[DIM], gcn_rows y)
+{
+    for (int k = 0; k < 4 && i + k < end; k++)
+    {
+        int u = rows ? rows[i + k] : i + k;
+        float m = 0.0f;
+        for (int j = 0; j < DIM; j++)
+            m = _o[k][j] > m ? _o[k][j] : m;
+        y.rs[u] = m / 127.0f;
+        typename V::vec inv = V::set1(m > 0.0f ? 127.0f / m : 0.0f);
+        for (int j = 0; j < DIM; j += V::W)
+            V::store((uint8_t *)y.a + u * DIM + j, V::mul(V::load(&_o[k][j]), inv));
+    }
+}
+
+// dense part of the input and hidden layers for 4 rows starting at i: y = ReLU(B + _y W),
+// 4 x R registers of columns at a time
+template <typename V, int DIM, int K, typename Y>
+inline void gcn_dense(int i, int end, const int *rows, const float (*_y)[K], const gcn_weights &w, gcn_rows y)
+{
+    constexpr int R = gcn_min<V::R, DIM / V::W>();
+    const float *__restrict__ W = w.W;
+    const float *__restrict__ B = w.B;
+
+    // int8 rows are scaled once the whole row is known
+    alignas(64) float _o[gcn_int8<Y>() ? 4 : 1][DIM];
+
+    for (int j = 0; j < DIM; j += R * V::W)
+    {
+        typename V::vec c[4][R];
+        for (int k = 0; k < 4; k++)
+            for (int r = 0; r < R; r++)
+                c[k][r] = V::load(&B[j + r * V::W]);
+
+        for (int k = 0; k < K; k++)
+        {
+            typename V::vec b[R];
+            for (int r = 0; r < R; r++)
+                b[r] = V::load(&W[k * DIM + j + r * V::W]);
+
+            for (int l = 0; l < 4; l++)
+            {
+                typename V::vec a = V::set1(_y[l][k]);
+                for (int r = 0; r < R; r++)
+                    c[l][r] = V::fmadd(a, b[r], c[l][r]);
+            }
+        }
+
+        typename V::vec zero = V::zero();
+        for (int k = 0; k < 4; k++)
+        {
+            int u = i + k;
+            if (rows)
+            {
+                if (u >= end)
+                    break;
+                u = rows[u];
+            }
+            // ReLU before storing results
+            for (int r = 0; r < R; r++)
+            {
+                if constexpr (gcn_int8<Y>())
+                    V::store(&_o[k][j + r * V::W], V::max(c[k][r], zero));
+                else
+                    V::store((Y *)y.a + u * DIM + j + r * V::W, V::max(c[k][r], zero));
+            }
+        }
+    }
+
+    if constexpr (gcn_int8<Y>())
+        gcn_store_int8<V, DIM>(i, end, rows, _o, y);
+}
+
+// dense part of the hidden layers of int8 models: the rows of _y are rounded to 7 bits like the
+// activations and multiplied with the int8 weights in int32
+template <typename V, int DIM>
+inline void gcn_dense_int8(int i, int end, const int *rows, const float (*_y)[DIM], const gcn_weights &w, gcn_rows y)
+{
+    constexpr int R = gcn_min<V::R, DIM / V::W>();
+
+    alignas(64) uint8_t _q[4][DIM];
+    float ry[4];
+    for (int l = 0; l < 4; l++)
+    {
+        if (i + l >= end)
+        {
+            memset(_q[l], 0, DIM);
+            ry[l] = 0.0f;
+            continue;
+        }
+        float m = 0.0f;
+        for (int k = 0; k < DIM; k++)
+            m = _y[l][k] > m ? _y[l][k] : m;
+        ry[l] = m / 127.0f;
+        typename V::vec inv = V::set1(m > 0.0f ? 127.0f / m : 0.0f);
+        for (int k = 0; k < DIM; k += V::W)
+            V::store(&_q[l][k], V::mul(V::load(&_y[l][k]), inv));
+    }
+
+    alignas(64) float _o[4][DIM];
+    for (int j = 0; j < DIM; j += R * V::W)
+    {
+        typename V::veci c[4][R];
+        for (int l = 0; l < 4; l++)
+            for (int r = 0; r < R; r++)
+                c[l][r] = V::zeroi();
+
+        for (int k = 0; k < DIM; k += 4)
+        {
+            typename V::veci b[R];
+            for (int r = 0; r < R; r++)
+                b[r] = V::loadi(&w.qW[k * DIM + (j + r * V::W) * 4]);
+
+            for (int l = 0; l < 4; l++)
+            {
+                int32_t a4;
+                memcpy(&a4, &_q[l][k], sizeof(a4));
+                typename V::veci a = V::set1i(a4);
+                for (int r = 0; r < R; r++)
+                    c[l][r] = V::dot4(c[l][r], a, b[r]);
+            }
+        }
+
+        typename V::vec zero = V::zero();
+        for (int l = 0; l < 4; l++)
+        {
+            typename V::vec s = V::set1(ry[l]);
+            for (int r = 0; r < R; r++)
+            {
+                int col = j + r * V::W;
+                typename V::vec o = V::fmadd(V::cvt(c[l][r]), V::mul(s, V::load(&w.qs[col])), V::load(&w.B[col]));
+                V::store(&_o[l][col], V::max(o, zero));
+            }
+        }
+    }
+
+    gcn_store_int8<V, DIM>(i, end, rows, _o, y);
+}
+
+// message passing of the DIM wide rows: _y = scale[u] * (scale[u] * x[u] + sum of scale[v] * x[v] over the neighbours v),
+// wide rows are done in parts of A registers
+template <typename V, int DIM, typename X, typename G>
+inline void gcn_aggregate(int u, const G &g, gcn_rows x, const float *__restrict__ scale, float *_y)
+{
+    constexpr int A = gcn_min<V::A, DIM / V::W>();
+    const X *__restrict__ xa = (const X *)x.a;
+
+    typename V::vec su = V::set1(scale[u]);                                // Scale for u
+    typename V::vec cu = gcn_int8<X>() ? V::set1(scale[u] * x.rs[u]) : su; // Scale of the row of u
+    for (int c = 0; c < DIM; c += A * V::W)
+    {
+        typename V::vec yv[A];           // Output for u
+        const X *_xu = xa + u * DIM + c; // Input for u
+        for (int k = 0; k < A; k++)
+            yv[k] = V::mul(cu, V::load(_xu + k * V::W));
+
+        // Neighbors
+        for (int v : g[u])
+        {
+            typename V::vec sv = V::set1(gcn_int8<X>() ? scale[v] * x.rs[v] : scale[v]); // Scale for v
+            const X *_xv = xa + v * DIM + c;                                             // Input for v
+            for (int l = 0; l < A; l++)
+                yv[l] = V::fmadd(sv, V::load(_xv + l * V::W), yv[l]);
+        }
+
+        for (int k = 0; k < A; k++)
+            V::store(_y + c + k * V::W, V::mul(yv[k], su));
+    }
+}
+
+// fp32 input features, output in the precision Y
+template <typename V, int INPUT, int DIM, typename Y, typename G>
+void gcn_layer_input(int begin, int end, const int *rows, const G &g,
+                     const gcn_weights &w, gcn_rows x, gcn_rows y,
+                     const float *__restrict__ scale)
+{
+    const float *__restrict__ xa = (const float *)x.a;
+    float _y[4][INPUT];
+
+    for (int i = begin; i < end; i += 4)
+    {
+        // Compute message passing results
+        for (int j = 0; j < 4; j++)
+        {
+            if (i + j >= end)
+                break;
+            int u = rows ? rows[i + j] : i + j;
+
+            const float *_xu = xa + u * INPUT; // Input for u
+            for (int k = 0; k < INPUT; k++)
+                _y[j][k] = scale[u] * _xu[k];
+
+            // Neighbors
+            for (int v : g[u])
+            {
+                const float *_xv = xa + v * INPUT; // Input for v
+                for (int l = 0; l < INPUT; l++)
+                    _y[j][l] += scale[v] * _xv[l];
+            }
+
+            for (int k = 0; k < INPUT; k++)
+                _y[j][k] *= scale[u];
+        }
+
+        gcn_dense<V, DIM, INPUT, Y>(i, end, rows, _y, w, y);
+    }
+}
+
+template <typename V, int INPUT, int DIM, typename T, typename G>
+void gcn_layer_hidden(int begin, int end, const int *rows, const G &g,
+                      const gcn_weights &w, gcn_rows x, gcn_rows y,
+                      const float *__restrict__ scale)
+{
+    alignas(64) float _y[4][DIM];
+
+    for (int i = begin; i < end; i += 4)
+    {
+        // Compute message passing results
+        for (int j = 0; j < 4; j++)
+        {
+            if (i + j >= end)
+                break;
+            gcn_aggregate<V, DIM, T>(rows ? rows[i + j] : i + j, g, x, scale, _y[j]);
+        }
+
+        if constexpr (gcn_int8<T>())
+            gcn_dense_int8<V, DIM>(i, end, rows, _y, w, y);
+        else
+            gcn_dense<V, DIM, DIM, T>(i, end, rows, _y, w, y);
+    }
+}
+
+// input in the precision X, output dim = 1 in fp32
+template <typename V, int INPUT, int DIM, typename X, typename G>
+void gcn_layer_output(int begin, int end, const int *rows, const G &g,
+                      const gcn_weights &w, gcn_rows x, gcn_rows y,
+                      const float *__restrict__ scale)
+{
+    alignas(64) float _y[DIM];
+
+    for (int i = begin; i < end; i++)
+    {
+        int u = rows ? rows[i] : i;
+        gcn_aggregate<V, DIM, X>(u, g, x, scale, _y);
+
+        // Compute dense layer part
+        typename V::vec c = V::zero();
+        for (int k = 0; k < DIM; k += V::W)
+            c = V::fmadd(V::load(&_y[k]), V::load(&w.W[k]), c);
+
+        ((float *)y.a)[u] = V::sum(c) + w.B[0];
+    }
+}
+
+template <typename V, int INPUT, int DIM, typename T>
+gcn_kernels gcn_make_kernels()
+{
+    return {gcn_layer_input<V, INPUT, DIM, T, csr_lists>, gcn_layer_hidden<V, INPUT, DIM, T, csr_lists>,
+            gcn_layer_output<V, INPUT, DIM, T, csr_lists>, gcn_layer_input<V, INPUT, DIM, T, dyn_csr>,
+            gcn_layer_hidden<V, INPUT, DIM, T, dyn_csr>, gcn_layer_output<V, INPUT, DIM, T, dyn_csr>};
+}
+
+template <typename V, int INPUT, int DIM>
+gcn_kernels gcn_make_kernels(int precision)
+{
+    switch (precision)
+    {
+    case GCN_FP32:
+        return gcn_make_kernels<V, INPUT, DIM, float>();
+    case GCN_BF16:
+        return gcn_make_kernels<V, INPUT, DIM, gcn_bf16>();
+    case GCN_INT8:
+        return gcn_make_kernels<V, INPUT, DIM, uint8_t>();
+    }
+    return {};
+}
+
+// the instantiated model shapes. The input features are all ones, so only INPUT = 1 is built.
+template <typename V>
+gcn_kernels gcn_make_kernels(int input, int dim, int precision)
+{
+    if (input == 1)
+    {
+        switch (dim)
+        {
+        case 16:
+            return gcn_make_kernels<V, 1, 16>(precision);
+        case 32:
+            return gcn_make_kernels<V, 1, 32>(precision);
+        case 64:
+            return gcn_make_kernels<V, 1, 64>(precision);
+        case 128:
+            return gcn_make_kernels<V, 1, 128>(precision);
+        }
+    }
+    return {};
+}
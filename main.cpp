@@ -1,14 +1,25 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <sstream>
+#include <deque>
+#include <condition_variable>
+#include <chrono>
 
 #include "algo/branch_and_reduce_algorithm.h"
 #include "algo/timer.h"
 
 #include "algo/tools/debug_info_logger.h"
+#include "algo/tools/remote_pool.h"
 
 #include "IO/write_solution.h"
 #include "IO/read_graph.h"
+#include "IO/binary_graph.h"
 
 int branching_strat = 2;
 
@@ -16,42 +27,398 @@ long tuningParam1;
 double tuningParam2;
 long tuningParam3;
 
-void setParams(int argc)
+// parameters of strategy strat, tuning parameters missing on the command line get the defaults of the strategy
+void setParams(int argc, int strat, solver_config &config)
 {
+    config.BRANCHING = strat;
+    config.TUNING_PARAM1 = tuningParam1;
+    config.TUNING_PARAM2 = tuningParam2;
+    config.TUNING_PARAM3 = tuningParam3;
+
     if (argc < 5)
     {
-        if (branching_strat == 4)
-            tuningParam1 = 25;
-        else if (branching_strat == 5)
-            tuningParam1 = 50;
-        else if (branching_strat >= 6)
-            tuningParam1 = 2;
+        if (strat == 4)
+            config.TUNING_PARAM1 = 25;
+        else if (strat == 5)
+            config.TUNING_PARAM1 = 50;
+        else if (strat >= 6)
+            config.TUNING_PARAM1 = 2;
     }
 
     if (argc < 6)
     {
-        if (branching_strat == 4)
-            tuningParam2 = 0.1;
-        else if (branching_strat == 5)
-            tuningParam2 = 0.4;
+        if (strat == 4)
+            config.TUNING_PARAM2 = 0.1;
+        else if (strat == 5)
+            config.TUNING_PARAM2 = 0.4;
     }
 
     if (argc < 7)
     {
-        if (branching_strat == 4)
-            tuningParam3 = 10;
-        else if (branching_strat == 5)
-            tuningParam3 = 3;
+        if (strat == 4)
+            config.TUNING_PARAM3 = 10;
+        else if (strat == 5)
+            config.TUNING_PARAM3 = 3;
+    }
+
+    config.USE_DEPENDENCY_CHECKING = true;
+    
+    if (config.BRANCHING == 2 && config.TUNING_PARAM3 == 1) 
+    {
+        config.USE_DEPENDENCY_CHECKING = false;
+    }
+}
+
+// serializes the output of concurrent jobs
+std::mutex io_mutex;
+
+// --workers: processes that search subtrees of the solves
+remote_pool *remote = nullptr;
+
+// --check-precision: the fp32 model that the picks of the --precision model are compared with
+gcn fp32Model = {};
+
+// --worker: solves the tasks of a coordinator, which arrive on stdin, and answers on stdout
+void run_worker(solver_config const &config, gcn const &model)
+{
+    int in = 0, out = dup(1);
+    dup2(2, 1); // nothing else may write to the channel
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::mutex out_mutex;
+    std::deque<remote_message> tasks;
+    bool quit = false;
+    int current = -1;
+    std::shared_ptr<std::atomic<int>> best;
+    std::thread reader([&]() {
+        remote_message msg;
+        while (read_message(in, msg) && msg.type != remote_message::QUIT)
+        {
+            std::lock_guard<std::mutex> lk(m);
+            if (msg.type == remote_message::TASK)
+            {
+                tasks.push_back(std::move(msg));
+                cv.notify_all();
+            }
+            else if (msg.type == remote_message::BOUND && msg.task == current)
+            {
+                int b = *best;
+                while (msg.data[0] < b && !best->compare_exchange_weak(b, msg.data[0]))
+                    ;
+            }
+        }
+        std::lock_guard<std::mutex> lk(m);
+        quit = true;
+        cv.notify_all();
+    });
+
+    for (;;)
+    {
+        remote_message task;
+        {
+            std::unique_lock<std::mutex> lk(m);
+            cv.wait(lk, [&]() { return quit || !tasks.empty(); });
+            if (tasks.empty())
+                break;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        int bound = task.data[0], seconds = task.data[1], N = task.data[2], M = task.data[3];
+        std::vector<long long> offsets(task.data.begin() + 4, task.data.begin() + 5 + N);
+        std::vector<int> nbr(task.data.begin() + 5 + N, task.data.end());
+        dyn_csr adj(offsets, nbr);
+
+        debug_info_logger logger("task_" + to_string(task.task), N, M / 2);
+        int *V = (int *)malloc(sizeof(int) * N * 2);
+        int *E = (int *)malloc(sizeof(int) * (M * 2 + 1));
+        branch_and_reduce_algorithm algo(adj, N, config);
+        algo.logger = &logger;
+        algo.model = model;
+        algo.model_data = gcn_data_init(model, N * 2, V, E, branch_and_reduce_algorithm::shared_pool(config));
+        algo.opt = bound; // only covers below the bound are of interest
+        algo.sharedOpt = std::make_shared<std::atomic<int>>(bound);
+        {
+            std::lock_guard<std::mutex> lk(m);
+            current = task.task;
+            best = algo.sharedOpt;
+        }
+
+        // passes own improvements on to the coordinator while the search runs
+        std::atomic<bool> done(false);
+        std::thread reporter([&]() {
+            int sent = bound;
+            while (!done)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                int b = *algo.sharedOpt;
+                if (b < sent)
+                {
+                    sent = b;
+                    std::lock_guard<std::mutex> lk(out_mutex);
+                    write_message(out, {remote_message::BOUND, task.task, {b}});
+                }
+            }
+        });
+        timer t;
+        algo.solve(t, seconds);
+        done = true;
+        reporter.join();
+        {
+            std::lock_guard<std::mutex> lk(m);
+            current = -1;
+        }
+
+        remote_message res{remote_message::RESULT, task.task, {algo.opt}};
+        push_long(res.data, algo.stats->nBranchings);
+        push_long(res.data, algo.stats->smallBranchings);
+        if (algo.opt < bound)
+            res.data.insert(res.data.end(), algo.y.begin(), algo.y.begin() + N);
+        {
+            std::lock_guard<std::mutex> lk(out_mutex);
+            write_message(out, res);
+        }
+        gcn_data_free(algo.model_data);
+        free(V);
+        free(E);
+    }
+    reader.join();
+}
+
+// solves a graph with every config at once (a portfolio), the first solver that finishes stops the others
+void solve_instance(std::filesystem::path const &path, std::vector<solver_config> const &configs, gcn const &model,
+                    std::string const &out_path, std::string const &out_path_log)
+{
+    {
+        std::lock_guard<std::mutex> lk(io_mutex);
+        std::cout << path << std::endl;
+    }
+    int P = configs.size();
+    int M = 0;
+    csr_graph csr;
+    std::vector<dyn_csr> adjs(P);
+    if (hasFreshBinaryGraph(path) && readBinaryGraph(path.string() + CSR_SUFFIX, csr))
+    {
+        M = csr.m;
+        if (P == 1)
+            adjs[0] = dyn_csr(csr.n, csr.offsets, (int *)csr.adj);
+        for (int k = 0; k < P && P > 1; k++) // every solver of a portfolio gets lists of its own
+        {
+            std::vector<long long> offsets(csr.offsets, csr.offsets + csr.n + 1);
+            std::vector<int> nbr(csr.adj, csr.adj + csr.m);
+            adjs[k] = dyn_csr(offsets, nbr);
+        }
+    }
+    else
+    {
+        std::vector<std::vector<int>> adjList = readGraphFromFile(path);
+        for (auto &entr: adjList)
+            M += entr.size();
+        for (int k = 0; k < P; k++)
+            adjs[k] = dyn_csr(adjList);
+    }
+    int N = adjs[0].size();
+
+    std::vector<std::unique_ptr<debug_info_logger>> loggers;
+    std::vector<std::unique_ptr<branch_and_reduce_algorithm>> algos;
+    std::vector<int *> buffers;
+    for (int k = 0; k < P; k++)
+    {
+        int *V = (int *)malloc(sizeof(int) * N * 2);
+        int *E = (int *)malloc(sizeof(int) * M * 2);
+        buffers.push_back(V);
+        buffers.push_back(E);
+
+        loggers.emplace_back(new debug_info_logger(path.filename(), N, M/2));
+        algos.emplace_back(new branch_and_reduce_algorithm(adjs[k], N, configs[k]));
+        branch_and_reduce_algorithm &algo = *algos.back();
+        algo.logger = loggers.back().get();
+        algo.remote = remote;
+        algo.model = model;
+        algo.model_data = gcn_data_init(model, N * 2, V, E, branch_and_reduce_algorithm::shared_pool(configs[k]));
+        algo.gcnRef = fp32Model;
+    }
+    timer t;
+    {
+        std::lock_guard<std::mutex> lk(io_mutex);
+        std::cout << "start" << std::endl;
+    }
+    t.restart();
+
+    int vcSize;
+    int winner = 0;
+    if (P == 1)
+    {
+        vcSize = algos[0]->solve(t, 1800);
+    }
+    else
+    {
+        // the solvers prune with the best solution of all of them, so the optimum is the best opt
+        // once one of them finished
+        std::shared_ptr<std::atomic<int>> sharedOpt = std::make_shared<std::atomic<int>>(N);
+        std::shared_ptr<std::atomic<bool>> cancel = std::make_shared<std::atomic<bool>>(false);
+        std::atomic<int> first(-1);
+        std::vector<std::thread> racers;
+        for (int k = 0; k < P; k++)
+        {
+            algos[k]->sharedOpt = sharedOpt;
+            algos[k]->cancel = cancel;
+            racers.emplace_back([&, k]() {
+                if (algos[k]->solve(t, 1800) < 0)
+                    return;
+                int none = -1;
+                first.compare_exchange_strong(none, k);
+                *cancel = true;
+            });
+        }
+        for (auto &r : racers)
+            r.join();
+        vcSize = -1;
+        if (first >= 0)
+        {
+            winner = first;
+            vcSize = N;
+            for (int k = 0; k < P; k++)
+                vcSize = std::min(vcSize, algos[k]->opt);
+            std::lock_guard<std::mutex> lk(io_mutex);
+            std::cout << "portfolio: strategy " << configs[winner].BRANCHING << " finished first" << std::endl;
+        }
+    }
+    double secs = t.elapsed();
+
+    Result res(path.filename(), algos[winner]->stats->nBranchings, secs, N - vcSize);
+    res.nSmallBranchings = algos[winner]->stats->smallBranchings;
+    // Timeout
+    if (vcSize == -1)
+    {
+        res.nBranchings = -1;
+        res.nSmallBranchings = -1;
+        res.time = -1;
+    }
+    else
+        res.misSize = N - vcSize;
+
+    {
+        std::lock_guard<std::mutex> lk(io_mutex);
+        writeResultToFile(res, out_path);
+        loggers[winner]->write_log(out_path_log);
+        solver_stats &s = *algos[winner]->stats;
+        if (fp32Model.params != NULL && s.precisionPicks > 0)
+            std::cout << "precision: " << s.precisionMisses << " of " << s.precisionPicks
+                      << " picks differ from fp32, mean fp32 score loss " << s.precisionLoss / s.precisionPicks << std::endl;
     }
 
-    branch_and_reduce_algorithm::BRANCHING = branching_strat;
-    branch_and_reduce_algorithm::TUNING_PARAM1 = tuningParam1;
-    branch_and_reduce_algorithm::TUNING_PARAM2 = tuningParam2;
-    branch_and_reduce_algorithm::TUNING_PARAM3 = tuningParam3;   
+    for (int k = 0; k < P; k++)
+        gcn_data_free(algos[k]->model_data);
+    for (int *b : buffers)
+        free(b);
 }
 
 int main(int argc, char **argv)
 {
+    // --jobs N solves N instances at a time, --portfolio 2,4,14 races the given strategies,
+    // --workers N hands subtrees to N worker processes (started with the same arguments and --worker),
+    // --kernels avx2 uses narrower GCN kernels than the CPU supports, --precision bf16|int8 evaluates the GCN
+    // in reduced precision, --check-precision compares its picks with fp32, --threads N and --split-n N run the
+    // search of a graph on N threads and split nodes with at least N vertices, --speculate-depth, --partition-n
+    // and --parallel-cc-n set the other parameters of the parallel search, --small-n N solves kernels with
+    // at most N vertices with bitsets, the other arguments are positional
+    int jobs = 1;
+    int nWorkers = 0;
+    bool worker = false;
+    int precision = GCN_FP32;
+    bool checkPrecision = false;
+    std::vector<int> portfolio;
+    solver_config defaults; // search parameters given on the command line, passed on to workers in searchArgs
+    std::vector<std::string> searchArgs;
+    std::vector<char *> args;
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("popcnt"))
+    {
+        fprintf(stderr, "MIS needs a CPU with POPCNT\n");
+        exit(1);
+    }
+    for (int i = 0; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--jobs" && i + 1 < argc)
+            jobs = atoi(argv[++i]);
+        else if (std::string(argv[i]) == "--workers" && i + 1 < argc)
+            nWorkers = atoi(argv[++i]);
+        else if (std::string(argv[i]) == "--worker")
+            worker = true;
+        else if (std::string(argv[i]) == "--kernels" && i + 1 < argc)
+        {
+            if (!gcn_use_kernels(argv[++i]))
+            {
+                fprintf(stderr, "GCN kernels %s not supported\n", argv[i]);
+                exit(1);
+            }
+        }
+        else if (std::string(argv[i]) == "--precision" && i + 1 < argc)
+        {
+            std::string p = argv[++i];
+            if (p == "fp32")
+                precision = GCN_FP32;
+            else if (p == "bf16")
+                precision = GCN_BF16;
+            else if (p == "int8")
+                precision = GCN_INT8;
+            else
+            {
+                fprintf(stderr, "GCN precision %s not supported (fp32, bf16, int8)\n", p.c_str());
+                exit(1);
+            }
+        }
+        else if (std::string(argv[i]) == "--check-precision")
+            checkPrecision = true;
+        else if (std::string(argv[i]) == "--threads" && i + 1 < argc)
+        {
+            defaults.THREADS = atoi(argv[++i]);
+            searchArgs.insert(searchArgs.end(), {argv[i - 1], argv[i]});
+        }
+        else if (std::string(argv[i]) == "--split-n" && i + 1 < argc)
+        {
+            defaults.SPLIT_N = atoi(argv[++i]);
+            searchArgs.insert(searchArgs.end(), {argv[i - 1], argv[i]});
+        }
+        else if (std::string(argv[i]) == "--speculate-depth" && i + 1 < argc)
+        {
+            defaults.SPECULATE_DEPTH = atoi(argv[++i]);
+            searchArgs.insert(searchArgs.end(), {argv[i - 1], argv[i]});
+        }
+        else if (std::string(argv[i]) == "--partition-n" && i + 1 < argc)
+        {
+            defaults.PARTITION_N = atoi(argv[++i]);
+            searchArgs.insert(searchArgs.end(), {argv[i - 1], argv[i]});
+        }
+        else if (std::string(argv[i]) == "--parallel-cc-n" && i + 1 < argc)
+        {
+            defaults.PARALLEL_CC_N = atoi(argv[++i]);
+            searchArgs.insert(searchArgs.end(), {argv[i - 1], argv[i]});
+        }
+        else if (std::string(argv[i]) == "--small-n" && i + 1 < argc)
+        {
+            defaults.SMALL_N = atoi(argv[++i]);
+            if (defaults.SMALL_N < 0 || defaults.SMALL_N > 256)
+            {
+                fprintf(stderr, "--small-n %s not supported (0 to 256)\n", argv[i]);
+                exit(1);
+            }
+            searchArgs.insert(searchArgs.end(), {argv[i - 1], argv[i]});
+        }
+        else if (std::string(argv[i]) == "--portfolio" && i + 1 < argc)
+        {
+            std::stringstream ss(argv[++i]);
+            std::string strat;
+            while (std::getline(ss, strat, ','))
+                portfolio.push_back(atoi(strat.c_str()));
+        }
+        else
+            args.push_back(argv[i]);
+    }
+    argc = args.size();
+    argv = args.data();
+
     if (argc < 4)
         exit(-1);
 
@@ -68,78 +435,93 @@ int main(int argc, char **argv)
     if (argc > 7)
         tuningParam3 = atoi(argv[7]); 
 
-    setParams(argc - 1);
+    std::vector<solver_config> configs(1, defaults);
+    setParams(argc - 1, branching_strat, configs[0]);
+    tuningParam1 = configs[0].TUNING_PARAM1;
+    tuningParam2 = configs[0].TUNING_PARAM2;
+    tuningParam3 = configs[0].TUNING_PARAM3;
+    if (!portfolio.empty())
+    {
+        configs.resize(portfolio.size(), defaults);
+        for (unsigned int k = 0; k < portfolio.size(); k++)
+            setParams(argc - 1, portfolio[k], configs[k]);
+    }
+    string strat_name = portfolio.empty() ? to_string(branching_strat) : "portfolio";
 
     
-    string out_path_log = out_path + "/log_" + to_string(branching_strat) + "_" 
+    string out_path_log = out_path + "/log_" + strat_name + "_" 
                           + to_string(tuningParam1) + "_" 
                           + to_string(tuningParam2) + "_" 
                           + to_string(tuningParam3) + ".txt";
 
-    out_path += "/results_" + to_string(branching_strat) + "_" 
+    out_path += "/results_" + strat_name + "_" 
                           + to_string(tuningParam1) + "_" 
                           + to_string(tuningParam2) + "_" 
                           + to_string(tuningParam3) + ".txt";
                           
-    branch_and_reduce_algorithm::USE_DEPENDENCY_CHECKING = true;
-    
-    if (branch_and_reduce_algorithm::BRANCHING == 2 && branch_and_reduce_algorithm::TUNING_PARAM3 == 1) 
-    {
-        branch_and_reduce_algorithm::USE_DEPENDENCY_CHECKING = false;
-    }
-
     FILE *f = fopen(model_path.data(), "r");
     gcn model = gcn_parse(f);
     fclose(f);
+    if (precision != GCN_FP32)
+    {
+        gcn fp32 = model;
+        model = gcn_with_precision(fp32, precision);
+        if (checkPrecision && !worker)
+            fp32Model = fp32;
+        else
+            gcn_free(fp32);
+    }
+
+    if (worker)
+    {
+        run_worker(configs[0], model);
+        return 0;
+    }
+    std::unique_ptr<remote_pool> pool;
+    if (nWorkers > 0)
+    {
+        std::vector<std::string> cmd{"/proc/self/exe"};
+        cmd.insert(cmd.end(), argv + 1, argv + argc);
+        cmd.insert(cmd.end(), {"--kernels", gcn_kernels_name(), "--worker"});
+        cmd.insert(cmd.end(), searchArgs.begin(), searchArgs.end());
+        if (precision == GCN_BF16)
+            cmd.insert(cmd.end(), {"--precision", "bf16"});
+        else if (precision == GCN_INT8)
+            cmd.insert(cmd.end(), {"--precision", "int8"});
+        pool.reset(new remote_pool(cmd, nWorkers));
+        remote = pool.get();
+    }
     
+    std::vector<std::filesystem::path> instances;
     for (const auto &entry : std::filesystem::directory_iterator(instances_path))
+        if (!entry.is_directory() && entry.path().extension() != CSR_SUFFIX && entry.path().extension() != CSR_TMP_SUFFIX)
+            instances.push_back(entry.path());
+
+    if (jobs <= 1)
     {
-        if (!entry.is_directory())
-        {
-            std::cout << entry.path() << std::endl;
-            std::vector<std::vector<int>> adj = readGraphFromFile(entry.path());
-            int N = adj.size();
-            int M = 0;
-            for (auto entr: adj)
-                M += entr.size();
-
-            int *V = (int *)malloc(sizeof(int) * N * 2);
-            int *E = (int *)malloc(sizeof(int) * M * 2);
-            
-            gcn_data model_data = gcn_data_init(N * 2, V, E);
-
-            debug_info_logger logger(entry.path().filename(), N, M/2);
-             
-            branch_and_reduce_algorithm::resetStatistics();
-            branch_and_reduce_algorithm algo = branch_and_reduce_algorithm(adj, adj.size());
-            algo.logger = &logger;
-            algo.model = model;
-            algo.model_data = model_data;
-            timer t;
-            std::cout << "start" << std::endl;
-            t.restart();
-
-            int vcSize = algo.solve(t, 1800);
-            double secs = t.elapsed();
-
-            Result res(entry.path().filename(), algo.nBranchings, secs, N - vcSize);
-            // Timeout
-            if (vcSize == -1)
-            {
-                res.nBranchings = -1;
-                res.time = -1;
-            }
-            else
-                res.misSize = N - vcSize;
+        for (const auto &path : instances)
+            solve_instance(path, configs, model, out_path, out_path_log);
+        return 0;
+    }
 
-            writeResultToFile(res, out_path);
-            logger.write_log(out_path_log);
+    // largest files first, so the long solves do not end up at the tail of the batch
+    std::vector<std::pair<uintmax_t, int>> order;
+    for (int i = 0; i < static_cast<int>(instances.size()); i++)
+        order.emplace_back(std::filesystem::file_size(instances[i]), i);
+    std::sort(order.begin(), order.end(), std::greater<std::pair<uintmax_t, int>>());
 
-            gcn_data_free(model_data);
-            free(V);
-            free(E);
-        }
-    }
+    // the jobs already keep the cores busy, every solve runs on its own thread
+    for (solver_config &config : configs)
+        config.THREADS = 1;
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    for (int j = 0; j < jobs; j++)
+        workers.emplace_back([&]() {
+            for (int i = next++; i < static_cast<int>(order.size()); i = next++)
+                solve_instance(instances[order[i].second], configs, model, out_path, out_path_log);
+        });
+    for (auto &w : workers)
+        w.join();
 
     return 0;
 }